@@ -28,6 +28,16 @@ export UA_CA_CRT_PATH="/home/yaroslav/x509/root-ca.pem"
 export UA_SIGNING_CA_CRT_PATH="/home/yaroslav/x509/signing-ca.pem"
 export UA_SIGNING_CA_KEY_PATH="/home/yaroslav/x509/signing-ca-key.pem"
 export UA_SIGNING_CA_KEY_PASS="U$vN#@D,v)*$N9\N"
+#seconds between CA file checks, 0 reloads on SIGHUP only
+export UA_CA_RELOAD_INTERVAL="30"
+#user PKCS12 encryption: aes256 (PBKDF2-HMAC-SHA256, AES-256-CBC, SHA-256 MAC) or legacy (3DES, SHA-1 MAC)
+export UA_PKCS12_PROFILE="aes256"
+export UA_PKCS12_ITERATIONS="20000"
+export UA_PKCS12_MAC_ITERATIONS="2048"
+#user PKCS12 keys: rsa2048, rsa3072 or ec256, pre-generated by low priority threads, pool size 0 generates on request
+export UA_PKCS12_KEY_TYPE="rsa2048"
+export UA_KEYPAIR_POOL_SIZE="32"
+export UA_KEYPAIR_POOL_THREADS="1"
 
 #ucontrol certificates part
 export UA_CLIENT_CRT_PATH="/home/yaroslav/x509/clientCert.pem"
@@ -38,5 +48,42 @@ export UA_CLIENT_KEY_PASS="password"
 export UA_SENTRY_DSN=""
 export UA_SENTRY_TRACES_SAMPLE_RATE=""
 
+#http keep-alive params (requests per connection, idle timeout in seconds)
+export UA_HTTP_KEEP_ALIVE_MAX="100"
+export UA_HTTP_KEEP_ALIVE_TIMEOUT="60"
+#"1" streams list bodies as chunked transfer encoding
+export UA_HTTP_STREAM_LISTS="1"
+#lists streamed at once, each holds a DB worker and connection while the client reads,
+#capped below UA_DB_WORKERS and UA_DB_POOL_SIZE_MAX, further lists are answered buffered
+export UA_HTTP_STREAMS_MAX="4"
+
+#io model ("shared" or "sharded"), shards "0" is one per core, "1" pins shard threads to cores
+export UA_IO_MODEL="${UA_IO_MODEL:-shared}"
+export UA_IO_SHARDS="${UA_IO_SHARDS:-0}"
+export UA_IO_PIN_THREADS="${UA_IO_PIN_THREADS:-0}"
+
+export UA_DB_WORKERS="8"
+export UA_DB_QUEUE_MAX="1024"
+#certificate issuance workers and queue, 503 with Retry-After when full
+export UA_CRYPTO_WORKERS="2"
+export UA_CRYPTO_QUEUE_MAX="64"
+
+export UA_DB_CONN_MAX_LIFETIME="1800"
+export UA_DB_POOL_ACQUIRE_TIMEOUT="5000"
+
+#"1" needs table_counters, uatables installs its triggers only when run with the same "1" and drops them otherwise
+export UA_DB_TOTALS_FROM_COUNTERS="0"
+
+#"auto" listens when uatables created the uauth_change_notify triggers and warns when they are missing,
+#"0" leaves other replicas allowing revoked grants up to UA_AUTHZ_REFRESH_INTERVAL
+export UA_DB_LISTEN="auto"
+export UA_DB_LISTEN_RECONNECT="5"
+
+export UA_AUTHZ_ENGINE="${UA_AUTHZ_ENGINE:-1}"
+export UA_AUTHZ_REFRESH_INTERVAL="60"
+export UA_AUTHZ_BATCH_MAX="100"
+export UA_AUTHZ_CACHE_SIZE="65536"
+export UA_AUTHZ_CACHE_TTL="60"
+
 ./uaserver
 
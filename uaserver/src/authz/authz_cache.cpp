@@ -0,0 +1,121 @@
+#include "authz_cache.h"
+
+#include <set>
+#include <algorithm>
+#include <functional>
+
+authz_cache::cache_shard &authz_cache::shard_get(const std::string &key)
+{
+    return *shards_[std::hash<std::string> {}(key)%shards_.size()];
+}
+
+authz_cache::authz_cache(std::size_t capacity, int ttl)
+    :shard_capacity_{std::max<std::size_t>(1,(capacity+shards_count_-1)/shards_count_)},ttl_{std::max(1,ttl)}
+{
+    shards_.reserve(shards_count_);
+    for(std::size_t i=0;i<shards_count_;++i){
+        shards_.emplace_back(new cache_shard {});
+        shards_.back()->slots.reserve(shard_capacity_);
+        shards_.back()->index.reserve(shard_capacity_);
+    }
+}
+
+std::string authz_cache::key_make(const std::string &user_uid, const std::vector<std::string> &rp_idents)
+{
+    const std::set<std::string> idents {rp_idents.begin(),rp_idents.end()};
+    std::string key {user_uid};
+    for(const std::string& ident:idents){
+        key+=' ';
+        key+=ident;
+    }
+    return key;
+}
+
+std::uint64_t authz_cache::generation_get() const
+{
+    return generation_.load();
+}
+
+authz_result authz_cache::decision_get(const std::string &key)
+{
+    cache_shard& shard {shard_get(key)};
+    std::lock_guard<std::mutex> lock {shard.mutex};
+    const auto& it {shard.index.find(key)};
+    if(it==shard.index.end()){
+        misses_.fetch_add(1,std::memory_order_relaxed);
+        return authz_result::unknown;
+    }
+    cache_slot& slot {shard.slots[it->second]};
+    if(slot.generation!=generation_.load() || std::chrono::steady_clock::now()-slot.stored_at>ttl_){
+        stale_.fetch_add(1,std::memory_order_relaxed);
+        misses_.fetch_add(1,std::memory_order_relaxed);
+        return authz_result::unknown;
+    }
+    slot.referenced=true;
+    hits_.fetch_add(1,std::memory_order_relaxed);
+    return slot.allowed ? authz_result::allow : authz_result::deny;
+}
+
+void authz_cache::decision_put(const std::string &key, std::uint64_t generation, bool allowed)
+{
+    if(generation!=generation_.load()){
+        return;
+    }
+    cache_shard& shard {shard_get(key)};
+    std::lock_guard<std::mutex> lock {shard.mutex};
+    const auto& it {shard.index.find(key)};
+    if(it!=shard.index.end()){//refresh in place
+        cache_slot& slot {shard.slots[it->second]};
+        slot.generation=generation;
+        slot.stored_at=std::chrono::steady_clock::now();
+        slot.allowed=allowed;
+        return;
+    }
+
+    std::size_t index {shard.slots.size()};
+    if(index<shard_capacity_){
+        shard.slots.emplace_back();
+    }
+    else{//CLOCK, hand skips and clears referenced slots, first unreferenced one is evicted
+        while(shard.slots[shard.hand].referenced){
+            shard.slots[shard.hand].referenced=false;
+            shard.hand=(shard.hand+1)%shard.slots.size();
+        }
+        index=shard.hand;
+        shard.hand=(shard.hand+1)%shard.slots.size();
+        shard.index.erase(shard.slots[index].key);
+        evictions_.fetch_add(1,std::memory_order_relaxed);
+    }
+    cache_slot& slot {shard.slots[index]};
+    slot.key=key;
+    slot.generation=generation;
+    slot.stored_at=std::chrono::steady_clock::now();
+    slot.allowed=allowed;
+    slot.referenced=false;
+    shard.index.emplace(key,index);
+}
+
+void authz_cache::cache_invalidate()
+{
+    generation_.fetch_add(1);
+    invalidations_.fetch_add(1,std::memory_order_relaxed);
+}
+
+boost::json::object authz_cache::stats_get() const
+{
+    std::size_t entries {0};
+    for(const std::unique_ptr<cache_shard>& shard:shards_){
+        std::lock_guard<std::mutex> lock {shard->mutex};
+        entries+=shard->slots.size();
+    }
+    return boost::json::object {
+        {"generation",generation_.load()},
+        {"capacity",shard_capacity_*shards_.size()},
+        {"entries",entries},
+        {"hits",hits_.load(std::memory_order_relaxed)},
+        {"misses",misses_.load(std::memory_order_relaxed)},
+        {"stale",stale_.load(std::memory_order_relaxed)},
+        {"evictions",evictions_.load(std::memory_order_relaxed)},
+        {"invalidations",invalidations_.load(std::memory_order_relaxed)}
+    };
+}
@@ -0,0 +1,67 @@
+#ifndef AUTHZ_CACHE_H
+#define AUTHZ_CACHE_H
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <boost/json.hpp>
+
+#include "authz_engine.h"
+
+//Bounded decision cache keyed by (user_uid, normalized rp_ident), CLOCK eviction per shard,
+//entries stored under an older generation or past ttl are never served
+class authz_cache
+{
+private:
+    struct cache_slot{
+        std::string key {};
+        std::uint64_t generation {0};
+        std::chrono::steady_clock::time_point stored_at {};
+        bool allowed {false};
+        //CLOCK reference bit, set on hit, cleared by the passing hand
+        bool referenced {false};
+    };
+    struct cache_shard{
+        std::mutex mutex;
+        std::vector<cache_slot> slots {};
+        std::unordered_map<std::string,std::size_t> index {};
+        std::size_t hand {0};
+    };
+    static const std::size_t shards_count_ {16};
+
+    std::size_t shard_capacity_ {0};
+    std::chrono::seconds ttl_ {60};
+    std::vector<std::unique_ptr<cache_shard>> shards_ {};
+    std::atomic<std::uint64_t> generation_ {1};
+
+    std::atomic<std::uint64_t> hits_ {0};
+    std::atomic<std::uint64_t> misses_ {0};
+    std::atomic<std::uint64_t> stale_ {0};
+    std::atomic<std::uint64_t> evictions_ {0};
+    std::atomic<std::uint64_t> invalidations_ {0};
+
+    cache_shard& shard_get(const std::string& key);
+
+public:
+    explicit authz_cache(std::size_t capacity,int ttl);
+    ~authz_cache()=default;
+
+    //user_uid and sorted, unique idents
+    static std::string key_make(const std::string& user_uid,const std::vector<std::string>& rp_idents);
+    //Taken before a decision is computed, passed back to decision_put
+    std::uint64_t generation_get() const;
+    //unknown on miss or stale entry
+    authz_result decision_get(const std::string& key);
+    //Dropped when generation moved on while the decision was computed
+    void decision_put(const std::string& key,std::uint64_t generation,bool allowed);
+    //Bump generation after any write to rp, relationship or urp tables
+    void cache_invalidate();
+    boost::json::object stats_get() const;
+};
+
+#endif // AUTHZ_CACHE_H
@@ -0,0 +1,321 @@
+#include "authz_engine.h"
+#include "dbase/dbase_pool.h"
+#include "executor/task_executor.h"
+
+#include <chrono>
+#include <algorithm>
+#include <boost/date_time.hpp>
+#include <boost/bind/bind.hpp>
+#include "spdlog/spdlog.h"
+
+void authz_engine::on_wait(const boost::system::error_code &ec)
+{
+    if(ec!=boost::asio::error::operation_aborted){
+        reload_schedule();
+        timer_.expires_from_now(boost::posix_time::seconds(refresh_interval_));
+        timer_.async_wait(boost::bind(&authz_engine::on_wait,this,boost::asio::placeholders::error));
+    }
+}
+
+void authz_engine::snapshot_reload()
+{
+    //generation is taken before reading, a write during load leaves the snapshot stale
+    const std::shared_ptr<authz_snapshot>& snapshot_ptr {std::make_shared<authz_snapshot>()};
+    snapshot_ptr->generation=generation_.load();
+
+    std::string msg {};
+    const std::chrono::steady_clock::time_point& started_at {std::chrono::steady_clock::now()};
+    if(!snapshot_build(*snapshot_ptr,msg)){
+        reload_errors_.fetch_add(1,std::memory_order_relaxed);
+        if(logger_ptr_){
+            logger_ptr_->error("{}, authz snapshot reload failed: {}",
+                BOOST_CURRENT_FUNCTION,msg);
+        }
+        return;
+    }
+    snapshot_ptr->load_us=std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now()-started_at).count();
+
+    {//reloads may overlap on the executor, an older one finishing last must not replace a newer snapshot
+        const std::shared_ptr<const authz_snapshot> snapshot {snapshot_ptr};
+        std::shared_ptr<const authz_snapshot> current {std::atomic_load(&snapshot_)};
+        do{
+            if(current && current->generation>snapshot->generation){
+                return;
+            }
+        }
+        while(!std::atomic_compare_exchange_weak(&snapshot_,&current,snapshot));
+    }
+    reloads_.fetch_add(1,std::memory_order_relaxed);
+    if(logger_ptr_){
+        logger_ptr_->debug("{}, authz snapshot loaded, rps: {}, users: {}, load_us: {}",
+            BOOST_CURRENT_FUNCTION,snapshot_ptr->rp_index.size(),snapshot_ptr->user_index.size(),snapshot_ptr->load_us);
+    }
+}
+
+bool authz_engine::snapshot_build(authz_snapshot &snapshot, std::string &msg)
+{
+    PGconn* conn_ptr {dbase_pool_ptr_->connection_acquire(msg)};
+    if(!conn_ptr){
+        return false;
+    }
+    PGresult* res_ptr {NULL};
+    {//one consistent view of the three tables
+        res_ptr=PQexec(conn_ptr,"BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+        if(PQresultStatus(res_ptr)!=PGRES_COMMAND_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            dbase_pool_ptr_->connection_release(conn_ptr);
+            return false;
+        }
+        PQclear(res_ptr);
+    }
+
+    std::vector<std::vector<std::uint32_t>> children {};
+    {//roles_permissions to dense indices
+        res_ptr=dbase_pool_ptr_->statement_exec(conn_ptr,"authz_rp_all",NULL);
+        if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            dbase_pool_ptr_->connection_release(conn_ptr);
+            return false;
+        }
+        const int& rows {PQntuples(res_ptr)};
+        snapshot.rp_index.reserve(rows);
+        snapshot.name_index.reserve(rows);
+        snapshot.rp_ids.reserve(rows);
+        snapshot.rp_names.reserve(rows);
+        for(int r=0;r<rows;++r){
+            const std::uint32_t& index {static_cast<std::uint32_t>(r)};
+            snapshot.rp_index.emplace(PQgetvalue(res_ptr,r,0),index);
+            snapshot.name_index.emplace(PQgetvalue(res_ptr,r,1),index);
+            snapshot.rp_ids.emplace_back(PQgetvalue(res_ptr,r,0));
+            snapshot.rp_names.emplace_back(PQgetvalue(res_ptr,r,1));
+        }
+        PQclear(res_ptr);
+        snapshot.words=(snapshot.rp_index.size()+63)/64;
+        children.resize(snapshot.rp_index.size());
+    }
+    {//roles_permissions_relationship to adjacency lists
+        res_ptr=dbase_pool_ptr_->statement_exec(conn_ptr,"authz_rpr_all",NULL);
+        if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            dbase_pool_ptr_->connection_release(conn_ptr);
+            return false;
+        }
+        const int& rows {PQntuples(res_ptr)};
+        for(int r=0;r<rows;++r){
+            const auto& parent_it {snapshot.rp_index.find(PQgetvalue(res_ptr,r,0))};
+            const auto& child_it {snapshot.rp_index.find(PQgetvalue(res_ptr,r,1))};
+            if(parent_it==snapshot.rp_index.end() || child_it==snapshot.rp_index.end()){
+                continue;
+            }
+            children[parent_it->second].push_back(child_it->second);
+            ++snapshot.relationships;
+        }
+        PQclear(res_ptr);
+    }
+    {//transitive closure per rp, iterative walk, cycles stop on visited bits
+        const std::size_t& words {snapshot.words};
+        snapshot.closures.assign(children.size()*words,0);
+        std::vector<std::uint32_t> stack {};
+        for(std::uint32_t root=0;root<children.size();++root){
+            std::uint64_t* row {snapshot.closures.data()+root*words};
+            stack.assign(1,root);
+            row[root/64]|=std::uint64_t {1}<<(root%64);
+            while(!stack.empty()){
+                const std::uint32_t index {stack.back()};
+                stack.pop_back();
+                for(const std::uint32_t& child:children[index]){
+                    const std::uint64_t& bit {std::uint64_t {1}<<(child%64)};
+                    if(!(row[child/64] & bit)){
+                        row[child/64]|=bit;
+                        stack.push_back(child);
+                    }
+                }
+            }
+        }
+    }
+    {//users_roles_permissions to effective rows per user
+        res_ptr=dbase_pool_ptr_->statement_exec(conn_ptr,"authz_urp_all",NULL);
+        if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            dbase_pool_ptr_->connection_release(conn_ptr);
+            return false;
+        }
+        const std::size_t& words {snapshot.words};
+        const auto& admin_it {snapshot.name_index.find(admin_name_)};
+        const int& rows {PQntuples(res_ptr)};
+        for(int r=0;r<rows;++r){
+            const auto& rp_it {snapshot.rp_index.find(PQgetvalue(res_ptr,r,1))};
+            if(rp_it==snapshot.rp_index.end()){
+                continue;
+            }
+            const auto& user_it {snapshot.user_index.emplace(PQgetvalue(res_ptr,r,0),
+                                                             static_cast<std::uint32_t>(snapshot.user_index.size()))};
+            if(user_it.second){
+                snapshot.effective.resize(snapshot.effective.size()+words,0);
+                snapshot.admins.push_back(false);
+            }
+            const std::uint32_t& user {user_it.first->second};
+            std::uint64_t* row {snapshot.effective.data()+user*words};
+            const std::uint64_t* closure {snapshot.closures.data()+rp_it->second*words};
+            for(std::size_t w=0;w<words;++w){
+                row[w]|=closure[w];
+            }
+            if(admin_it!=snapshot.name_index.end() && rp_it->second==admin_it->second){
+                snapshot.admins[user]=true;
+            }
+            ++snapshot.grants;
+        }
+        PQclear(res_ptr);
+    }
+    {//end read only transaction
+        res_ptr=PQexec(conn_ptr,"COMMIT");
+        PQclear(res_ptr);
+    }
+    dbase_pool_ptr_->connection_release(conn_ptr);
+    return true;
+}
+
+authz_engine::authz_engine(boost::asio::io_context &io, int refresh_interval, std::shared_ptr<dbase_pool> dbase_pool_ptr,
+                           std::shared_ptr<task_executor> dbase_executor_ptr, std::shared_ptr<spdlog::logger> logger_ptr)
+    :refresh_interval_{std::max(1,refresh_interval)},timer_{io},dbase_pool_ptr_{dbase_pool_ptr},
+     dbase_executor_ptr_{dbase_executor_ptr},logger_ptr_{logger_ptr}
+{
+}
+
+void authz_engine::engine_start()
+{
+    reload_schedule();
+    timer_.expires_from_now(boost::posix_time::seconds(refresh_interval_));
+    timer_.async_wait(boost::bind(&authz_engine::on_wait,this,boost::asio::placeholders::error));
+
+    if(logger_ptr_){
+        logger_ptr_->info("{}, authz_engine started",
+            BOOST_CURRENT_FUNCTION);
+    }
+}
+
+void authz_engine::engine_stop()
+{
+    boost::system::error_code ec;
+    timer_.cancel(ec);
+    if(logger_ptr_){
+        logger_ptr_->info("{}, authz_engine stopped",
+            BOOST_CURRENT_FUNCTION);
+    }
+}
+
+void authz_engine::engine_invalidate()
+{
+    generation_.fetch_add(1);
+    reload_schedule();
+}
+
+void authz_engine::reload_schedule()
+{
+    if(reload_pending_.exchange(true)){
+        return;
+    }
+    const std::shared_ptr<authz_engine>& self {shared_from_this()};
+    const bool& posted {dbase_executor_ptr_->task_post([self](){
+        self->reload_pending_.store(false);
+        self->snapshot_reload();
+    })};
+    if(!posted){
+        reload_pending_.store(false);
+    }
+}
+
+authz_result authz_engine::is_authorized(const std::string &user_uid, const std::vector<std::string> &rp_idents)
+{
+    const std::shared_ptr<const authz_snapshot>& snapshot_ptr {std::atomic_load(&snapshot_)};
+    if(!snapshot_ptr || snapshot_ptr->generation!=generation_.load()){
+        fallbacks_.fetch_add(1,std::memory_order_relaxed);
+        return authz_result::unknown;
+    }
+    decisions_.fetch_add(1,std::memory_order_relaxed);
+    if(rp_idents.empty()){
+        return authz_result::deny;
+    }
+
+    const auto& user_it {snapshot_ptr->user_index.find(user_uid)};
+    if(user_it==snapshot_ptr->user_index.end()){
+        return authz_result::deny;
+    }
+    const std::uint32_t& user {user_it->second};
+    if(snapshot_ptr->admins[user]){
+        return authz_result::allow;
+    }
+
+    //every ident must resolve, by rp_uid or name, to a granted or inherited rp
+    const std::uint64_t* row {snapshot_ptr->effective.data()+user*snapshot_ptr->words};
+    for(const std::string& rp_ident:rp_idents){
+        auto it {snapshot_ptr->rp_index.find(rp_ident)};
+        if(it==snapshot_ptr->rp_index.end()){
+            it=snapshot_ptr->name_index.find(rp_ident);
+            if(it==snapshot_ptr->name_index.end()){
+                return authz_result::deny;
+            }
+        }
+        const std::uint32_t& index {it->second};
+        if(!(row[index/64] & (std::uint64_t {1}<<(index%64)))){
+            return authz_result::deny;
+        }
+    }
+    return authz_result::allow;
+}
+
+bool authz_engine::effective_get(const std::string &user_uid, std::vector<std::pair<std::string, std::string>> &rps, bool &admin)
+{
+    const std::shared_ptr<const authz_snapshot>& snapshot_ptr {std::atomic_load(&snapshot_)};
+    if(!snapshot_ptr || snapshot_ptr->generation!=generation_.load()){
+        fallbacks_.fetch_add(1,std::memory_order_relaxed);
+        return false;
+    }
+    decisions_.fetch_add(1,std::memory_order_relaxed);
+    admin=false;
+    rps.clear();
+
+    const auto& user_it {snapshot_ptr->user_index.find(user_uid)};
+    if(user_it==snapshot_ptr->user_index.end()){
+        return true;
+    }
+    const std::uint32_t& user {user_it->second};
+    admin=snapshot_ptr->admins[user];
+    const std::uint64_t* row {snapshot_ptr->effective.data()+user*snapshot_ptr->words};
+    for(std::size_t w=0;w<snapshot_ptr->words;++w){
+        const std::uint64_t& bits {row[w]};
+        for(std::size_t b=0;b<64 && (bits>>b);++b){
+            if(bits & (std::uint64_t {1}<<b)){
+                const std::size_t& index {w*64+b};
+                rps.emplace_back(snapshot_ptr->rp_ids[index],snapshot_ptr->rp_names[index]);
+            }
+        }
+    }
+    return true;
+}
+
+boost::json::object authz_engine::stats_get() const
+{
+    const std::shared_ptr<const authz_snapshot>& snapshot_ptr {std::atomic_load(&snapshot_)};
+    boost::json::object stats {
+        {"generation",generation_.load()},
+        {"decisions",decisions_.load(std::memory_order_relaxed)},
+        {"fallbacks",fallbacks_.load(std::memory_order_relaxed)},
+        {"reloads",reloads_.load(std::memory_order_relaxed)},
+        {"reload_errors",reload_errors_.load(std::memory_order_relaxed)}
+    };
+    if(snapshot_ptr){
+        stats.emplace("snapshot_generation",snapshot_ptr->generation);
+        stats.emplace("rps",snapshot_ptr->rp_index.size());
+        stats.emplace("relationships",snapshot_ptr->relationships);
+        stats.emplace("users",snapshot_ptr->user_index.size());
+        stats.emplace("grants",snapshot_ptr->grants);
+        stats.emplace("load_us",snapshot_ptr->load_us);
+    }
+    return stats;
+}
@@ -0,0 +1,90 @@
+#ifndef AUTHZ_ENGINE_H
+#define AUTHZ_ENGINE_H
+
+#include <atomic>
+#include <string>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <unordered_map>
+#include <boost/asio.hpp>
+#include <boost/json.hpp>
+
+namespace spdlog{
+    class logger;
+}
+class dbase_pool;
+class task_executor;
+
+enum class authz_result{
+    allow,
+    deny,
+    unknown
+};
+
+//Immutable copy of roles_permissions, roles_permissions_relationship and users_roles_permissions
+struct authz_snapshot
+{
+    std::uint64_t generation {0};
+    std::size_t words {0};
+    std::unordered_map<std::string,std::uint32_t> rp_index {};
+    std::unordered_map<std::string,std::uint32_t> name_index {};
+    //dense index back to rp id and name
+    std::vector<std::string> rp_ids {};
+    std::vector<std::string> rp_names {};
+    //row per rp, bit set for every rp reachable through relationships, self included
+    std::vector<std::uint64_t> closures {};
+    std::unordered_map<std::string,std::uint32_t> user_index {};
+    //row per user, union of closures of directly granted rps
+    std::vector<std::uint64_t> effective {};
+    std::vector<bool> admins {};
+    std::size_t relationships {0};
+    std::size_t grants {0};
+    std::int64_t load_us {0};
+};
+
+//In-memory RBAC decisions, snapshot is rebuilt on the dbase executor and swapped atomically
+class authz_engine:public std::enable_shared_from_this<authz_engine>
+{
+private:
+    const std::string admin_name_ {"UAuthAdmin"};
+    int refresh_interval_ {60};
+    boost::asio::deadline_timer timer_;
+    std::shared_ptr<const authz_snapshot> snapshot_ {nullptr};
+    std::atomic<std::uint64_t> generation_ {1};
+    std::atomic<bool> reload_pending_ {false};
+
+    std::atomic<std::uint64_t> decisions_ {0};
+    std::atomic<std::uint64_t> fallbacks_ {0};
+    std::atomic<std::uint64_t> reloads_ {0};
+    std::atomic<std::uint64_t> reload_errors_ {0};
+
+    std::shared_ptr<dbase_pool> dbase_pool_ptr_ {nullptr};
+    std::shared_ptr<task_executor> dbase_executor_ptr_ {nullptr};
+    std::shared_ptr<spdlog::logger> logger_ptr_ {nullptr};
+
+    void on_wait(const boost::system::error_code& ec);
+    //Build new snapshot from database and swap it in, runs on dbase executor
+    void snapshot_reload();
+    bool snapshot_build(authz_snapshot& snapshot,std::string& msg);
+
+public:
+    explicit authz_engine(boost::asio::io_context& io,int refresh_interval,std::shared_ptr<dbase_pool> dbase_pool_ptr,
+                          std::shared_ptr<task_executor> dbase_executor_ptr,std::shared_ptr<spdlog::logger> logger_ptr);
+    ~authz_engine()=default;
+
+    void engine_start();
+    void engine_stop();
+    //Mark snapshot stale after a local write and schedule reload
+    void engine_invalidate();
+    //Schedule reload, coalesced while one is pending
+    void reload_schedule();
+    //unknown while no current snapshot, caller falls back to SQL
+    authz_result is_authorized(const std::string& user_uid,const std::vector<std::string>& rp_idents);
+    //Transitive rps of user as (id,name), false while no current snapshot
+    bool effective_get(const std::string& user_uid,std::vector<std::pair<std::string,std::string>>& rps,bool& admin);
+    boost::json::object stats_get() const;
+};
+
+#endif // AUTHZ_ENGINE_H
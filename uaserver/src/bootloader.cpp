@@ -2,8 +2,16 @@
 #include <settings/app_settings.h>
 #include "network/http_server.h"
 #include <ucontrol/uc_controller.h>
+#include <dbase/dbase_pool.h>
+#include <authz/authz_engine.h>
+#include <authz/authz_cache.h>
+#include <dbase/dbase_listener.h>
+#include <x509/x509_keystore.h>
+#include <x509/x509_keypair_pool.h>
+#include <executor/task_executor.h>
 
 #include <vector>
+#include <algorithm>
 #include <iostream>
 #include <boost/format.hpp>
 #include <boost/date_time.hpp>
@@ -74,9 +82,149 @@ void bootloader::init_spdlog()
     }
 }
 
+void bootloader::init_executors()
+{
+    const int& db_workers {app_settings_ptr_->value_get_int("UA_DB_WORKERS",8)};
+    const int& db_queue_max {app_settings_ptr_->value_get_int("UA_DB_QUEUE_MAX",1024)};
+    dbase_executor_ptr_=std::make_shared<task_executor>("dbase",
+                                                        static_cast<std::size_t>(std::max(1,db_workers)),
+                                                        static_cast<std::size_t>(std::max(1,db_queue_max)),
+                                                        logger_ptr_);
+    //small queue, a burst of enrollments is shed with 503 instead of piling up
+    const int& crypto_workers {app_settings_ptr_->value_get_int("UA_CRYPTO_WORKERS",2)};
+    const int& crypto_queue_max {app_settings_ptr_->value_get_int("UA_CRYPTO_QUEUE_MAX",64)};
+    crypto_executor_ptr_=std::make_shared<task_executor>("crypto",
+                                                         static_cast<std::size_t>(std::max(1,crypto_workers)),
+                                                         static_cast<std::size_t>(std::max(1,crypto_queue_max)),
+                                                         logger_ptr_);
+}
+
+void bootloader::init_dbase_pool()
+{
+    const boost::json::object& params {
+        {"UA_DB_NAME",app_settings_ptr_->value_get("UA_DB_NAME")},
+        {"UA_DB_HOST",app_settings_ptr_->value_get("UA_DB_HOST")},
+        {"UA_DB_PORT",app_settings_ptr_->value_get("UA_DB_PORT")},
+        {"UA_DB_USER",app_settings_ptr_->value_get("UA_DB_USER")},
+        {"UA_DB_PASS",app_settings_ptr_->value_get("UA_DB_PASS")}
+    };
+    const int& pool_min {app_settings_ptr_->value_get_int("UA_DB_POOL_SIZE_MIN",1)};
+    const int& pool_max {app_settings_ptr_->value_get_int("UA_DB_POOL_SIZE_MAX",100)};
+    const int& max_lifetime {app_settings_ptr_->value_get_int("UA_DB_CONN_MAX_LIFETIME",1800)};
+    const int& acquire_timeout {app_settings_ptr_->value_get_int("UA_DB_POOL_ACQUIRE_TIMEOUT",5000)};
+    dbase_pool_ptr_=std::make_shared<dbase_pool>(params,
+                                                 static_cast<std::size_t>(std::max(0,pool_min)),
+                                                 static_cast<std::size_t>(std::max(1,pool_max)),
+                                                 max_lifetime,acquire_timeout,logger_ptr_);
+
+    //open UA_DB_POOL_SIZE_MIN connections without blocking startup
+    const std::shared_ptr<dbase_pool>& pool_ptr {dbase_pool_ptr_};
+    dbase_executor_ptr_->task_post([pool_ptr](){
+        pool_ptr->pool_warmup();
+    });
+}
+
+void bootloader::init_authz_engine()
+{
+    const std::string& enabled {app_settings_ptr_->value_get("UA_AUTHZ_ENGINE")};
+    if(enabled!="1"){
+        return;
+    }
+    const int& refresh_interval {app_settings_ptr_->value_get_int("UA_AUTHZ_REFRESH_INTERVAL",60)};
+    authz_engine_ptr_=std::make_shared<authz_engine>(io_,refresh_interval,dbase_pool_ptr_,dbase_executor_ptr_,logger_ptr_);
+}
+
+void bootloader::init_authz_cache()
+{
+    //0 disables the decision cache
+    const int& cache_size {app_settings_ptr_->value_get_int("UA_AUTHZ_CACHE_SIZE",65536)};
+    if(cache_size<=0){
+        return;
+    }
+    const int& cache_ttl {app_settings_ptr_->value_get_int("UA_AUTHZ_CACHE_TTL",60)};
+    authz_cache_ptr_=std::make_shared<authz_cache>(static_cast<std::size_t>(cache_size),cache_ttl);
+}
+
+void bootloader::init_dbase_listener()
+{
+    //"auto" listens when uatables installed the uauth_change_notify triggers, "1" always, "0" never;
+    //without the feed revoked grants stay allowed by other replicas up to UA_AUTHZ_REFRESH_INTERVAL
+    const std::string& enabled {app_settings_ptr_->value_get("UA_DB_LISTEN")};
+    if(enabled=="0"){
+        if((authz_engine_ptr_ || authz_cache_ptr_) && logger_ptr_){
+            logger_ptr_->warn("{}, UA_DB_LISTEN is \"0\", authz state of other instances is refreshed by timer and TTL only",
+                BOOST_CURRENT_FUNCTION);
+        }
+        return;
+    }
+    if(enabled!="1"){
+        std::string msg {};
+        const int& triggers {dbase_listener::triggers_count(dbase_pool_ptr_,msg)};
+        if(!triggers){
+            if(logger_ptr_){
+                logger_ptr_->warn("{}, uauth_change_notify triggers missing, run uatables; changes of other instances are not listened to",
+                    BOOST_CURRENT_FUNCTION);
+            }
+            return;
+        }
+        if(triggers<0 && logger_ptr_){//database not reachable yet, listener retries on its own
+            logger_ptr_->warn("{}, uauth_change_notify triggers not checked, listening anyway: {}",
+                BOOST_CURRENT_FUNCTION,msg);
+        }
+    }
+    const int& reconnect_interval {app_settings_ptr_->value_get_int("UA_DB_LISTEN_RECONNECT",5)};
+    dbase_listener_ptr_=std::make_shared<dbase_listener>(io_,reconnect_interval,dbase_pool_ptr_,dbase_executor_ptr_,logger_ptr_);
+
+    //writes from other instances reach local authz state here
+    const std::shared_ptr<authz_engine>& engine_ptr {authz_engine_ptr_};
+    if(engine_ptr){
+        dbase_listener_ptr_->invalidator_add([engine_ptr](const dbase_change& change){
+            if(change.is_authz()){
+                engine_ptr->engine_invalidate();
+            }
+        });
+    }
+    const std::shared_ptr<authz_cache>& cache_ptr {authz_cache_ptr_};
+    if(cache_ptr){
+        dbase_listener_ptr_->invalidator_add([cache_ptr](const dbase_change& change){
+            if(change.is_authz()){
+                cache_ptr->cache_invalidate();
+            }
+        });
+    }
+}
+
+void bootloader::init_x509_keystore()
+{
+    //0 leaves reload to SIGHUP
+    const int& reload_interval {app_settings_ptr_->value_get_int("UA_CA_RELOAD_INTERVAL",30)};
+    x509_keystore_ptr_=std::make_shared<x509_keystore>(io_,app_settings_ptr_->value_get("UA_CA_CRT_PATH"),
+                                                       app_settings_ptr_->value_get("UA_SIGNING_CA_CRT_PATH"),
+                                                       app_settings_ptr_->value_get("UA_SIGNING_CA_KEY_PATH"),
+                                                       app_settings_ptr_->value_get("UA_SIGNING_CA_KEY_PASS"),
+                                                       reload_interval,logger_ptr_);
+    //certificate endpoints answer 503 until a later reload succeeds
+    std::string msg {};
+    x509_keystore_ptr_->keystore_reload(msg);
+}
+
+void bootloader::init_x509_keypair_pool()
+{
+    //0 pool size generates every user key on request
+    const std::string& key_type {app_settings_ptr_->value_get("UA_PKCS12_KEY_TYPE")};
+    const int& pool_size {app_settings_ptr_->value_get_int("UA_KEYPAIR_POOL_SIZE",32)};
+    const int& pool_threads {app_settings_ptr_->value_get_int("UA_KEYPAIR_POOL_THREADS",1)};
+    x509_keypair_pool_ptr_=std::make_shared<x509_keypair_pool>(key_type,
+                                                               static_cast<std::size_t>(std::max(0,pool_size)),
+                                                               static_cast<std::size_t>(std::max(1,pool_threads)),
+                                                               logger_ptr_);
+}
+
 bool bootloader::start_listen()
 {
-    http_server_ptr_.reset(new http_server{io_,app_dir_,app_settings_ptr_,logger_ptr_});
+    http_server_ptr_.reset(new http_server{io_,app_dir_,app_settings_ptr_,dbase_executor_ptr_,crypto_executor_ptr_,dbase_pool_ptr_,
+                                           authz_engine_ptr_,authz_cache_ptr_,x509_keystore_ptr_,x509_keypair_pool_ptr_,
+                                           logger_ptr_});
     if(!http_server_ptr_->server_listen()){
         http_server_ptr_.reset();
         return false;
@@ -141,11 +289,38 @@ bootloader::bootloader(boost::asio::io_context &io, const std::string &app_dir,
         }
     }
     init_spdlog();
+    init_executors();
+    init_dbase_pool();
+    init_authz_engine();
+    init_authz_cache();
+    init_dbase_listener();
+    init_x509_keystore();
+    init_x509_keypair_pool();
 }
 
 void bootloader::bootloader_start()
 {
 
+    {//start authz_engine
+        if(authz_engine_ptr_){
+            authz_engine_ptr_->engine_start();
+        }
+    }
+    {//start dbase_listener
+        if(dbase_listener_ptr_){
+            dbase_listener_ptr_->listener_start();
+        }
+    }
+    {//start x509_keystore
+        if(x509_keystore_ptr_){
+            x509_keystore_ptr_->keystore_start();
+        }
+    }
+    {//start x509_keypair_pool
+        if(x509_keypair_pool_ptr_){
+            x509_keypair_pool_ptr_->pool_start();
+        }
+    }
     {//init and start http_server timer
         timer_.expires_from_now(boost::posix_time::milliseconds(interval_));
         timer_.async_wait(boost::bind(&bootloader::on_wait,this,boost::asio::placeholders::error));
@@ -184,6 +359,39 @@ void bootloader::bootloader_stop()
             uc_controller_ptr_->controller_stop();
         }
     }
+    {//stop x509_keystore
+        if(x509_keystore_ptr_){
+            x509_keystore_ptr_->keystore_stop();
+        }
+    }
+    {//stop x509_keypair_pool
+        if(x509_keypair_pool_ptr_){
+            x509_keypair_pool_ptr_->pool_stop();
+        }
+    }
+    {//stop dbase_listener
+        if(dbase_listener_ptr_){
+            dbase_listener_ptr_->listener_stop();
+        }
+    }
+    {//stop authz_engine
+        if(authz_engine_ptr_){
+            authz_engine_ptr_->engine_stop();
+        }
+    }
+    {//stop executors
+        if(crypto_executor_ptr_){
+            crypto_executor_ptr_->executor_stop();
+        }
+        if(dbase_executor_ptr_){
+            dbase_executor_ptr_->executor_stop();
+        }
+    }
+    {//stop dbase pool
+        if(dbase_pool_ptr_){
+            dbase_pool_ptr_->pool_stop();
+        }
+    }
 
     if(logger_ptr_){
         logger_ptr_->info("{}, bootloader stopped",
@@ -14,6 +14,13 @@ namespace spdlog{
 class app_settings;
 class http_server;
 class uc_controller;
+class task_executor;
+class dbase_pool;
+class authz_engine;
+class authz_cache;
+class dbase_listener;
+class x509_keystore;
+class x509_keypair_pool;
 
 class bootloader
 {
@@ -39,9 +46,24 @@ private:
     std::shared_ptr<app_settings> app_settings_ptr_   {nullptr};
     std::shared_ptr<http_server> http_server_ptr_     {nullptr};
     std::shared_ptr<uc_controller> uc_controller_ptr_ {nullptr};
+    std::shared_ptr<task_executor> dbase_executor_ptr_ {nullptr};
+    std::shared_ptr<task_executor> crypto_executor_ptr_ {nullptr};
+    std::shared_ptr<dbase_pool> dbase_pool_ptr_ {nullptr};
+    std::shared_ptr<authz_engine> authz_engine_ptr_ {nullptr};
+    std::shared_ptr<authz_cache> authz_cache_ptr_ {nullptr};
+    std::shared_ptr<dbase_listener> dbase_listener_ptr_ {nullptr};
+    std::shared_ptr<x509_keystore> x509_keystore_ptr_ {nullptr};
+    std::shared_ptr<x509_keypair_pool> x509_keypair_pool_ptr_ {nullptr};
 
     bool init_dirs();
     void init_spdlog();
+    void init_executors();
+    void init_dbase_pool();
+    void init_authz_engine();
+    void init_authz_cache();
+    void init_dbase_listener();
+    void init_x509_keystore();
+    void init_x509_keypair_pool();
     bool start_listen();
     bool init_appsettings();
     void on_wait(const boost::system::error_code& ec);
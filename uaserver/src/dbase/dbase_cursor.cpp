@@ -0,0 +1,76 @@
+#include "dbase_cursor.h"
+
+const std::string dbase_cursor::alphabet_ {"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"};
+
+std::string dbase_cursor::cursor_encode(const std::vector<std::string> &keys)
+{
+    std::string plain {};
+    for(std::size_t i=0;i<keys.size();++i){
+        if(i){
+            plain+='|';
+        }
+        plain+=keys[i];
+    }
+
+    std::string cursor {};
+    cursor.reserve((plain.size()+2)/3*4);
+    std::size_t i {0};
+    for(;i+2<plain.size();i+=3){
+        const unsigned int& chunk {(static_cast<unsigned int>(static_cast<unsigned char>(plain[i]))<<16) |
+                                   (static_cast<unsigned int>(static_cast<unsigned char>(plain[i+1]))<<8) |
+                                    static_cast<unsigned int>(static_cast<unsigned char>(plain[i+2]))};
+        cursor+=alphabet_[(chunk>>18) & 0x3f];
+        cursor+=alphabet_[(chunk>>12) & 0x3f];
+        cursor+=alphabet_[(chunk>>6) & 0x3f];
+        cursor+=alphabet_[chunk & 0x3f];
+    }
+    const std::size_t& rest {plain.size()-i};
+    if(rest){//no padding
+        unsigned int chunk {static_cast<unsigned int>(static_cast<unsigned char>(plain[i]))<<16};
+        if(rest==2){
+            chunk|=static_cast<unsigned int>(static_cast<unsigned char>(plain[i+1]))<<8;
+        }
+        cursor+=alphabet_[(chunk>>18) & 0x3f];
+        cursor+=alphabet_[(chunk>>12) & 0x3f];
+        if(rest==2){
+            cursor+=alphabet_[(chunk>>6) & 0x3f];
+        }
+    }
+    return cursor;
+}
+
+bool dbase_cursor::cursor_decode(const std::string &cursor, std::size_t keys_count, std::vector<std::string> &keys)
+{
+    if(cursor.empty() || cursor.size()%4==1){
+        return false;
+    }
+    std::string plain {};
+    plain.reserve(cursor.size()/4*3+2);
+    unsigned int chunk {0};
+    int bits {0};
+    for(const char& c: cursor){
+        const std::size_t& pos {alphabet_.find(c)};
+        if(pos==std::string::npos){
+            return false;
+        }
+        chunk=(chunk<<6) | static_cast<unsigned int>(pos);
+        bits+=6;
+        if(bits>=8){
+            bits-=8;
+            plain+=static_cast<char>((chunk>>bits) & 0xff);
+        }
+    }
+
+    keys.clear();
+    std::size_t begin {0};
+    while(keys.size()+1<keys_count){
+        const std::size_t& end {plain.find('|',begin)};
+        if(end==std::string::npos){
+            return false;
+        }
+        keys.push_back(plain.substr(begin,end-begin));
+        begin=end+1;
+    }
+    keys.push_back(plain.substr(begin));
+    return true;
+}
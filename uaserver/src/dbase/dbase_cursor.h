@@ -0,0 +1,19 @@
+#ifndef DBASE_CURSOR_H
+#define DBASE_CURSOR_H
+
+#include <string>
+#include <vector>
+
+//Opaque keyset cursor: sort keys of the last row joined by '|' and base64url encoded
+class dbase_cursor
+{
+private:
+    static const std::string alphabet_;
+
+public:
+    static std::string cursor_encode(const std::vector<std::string>& keys);
+    //false if not valid base64url or fewer than keys_count keys, last key takes the rest
+    static bool cursor_decode(const std::string& cursor,std::size_t keys_count,std::vector<std::string>& keys);
+};
+
+#endif // DBASE_CURSOR_H
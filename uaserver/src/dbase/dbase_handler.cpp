@@ -1,6 +1,19 @@
 #include "dbase_handler.h"
-
+#include "dbase_pool.h"
+#include "dbase_cursor.h"
+#include "dbase_statements.h"
+#include "dbase_json_encoder.h"
+#include "authz/authz_engine.h"
+#include "authz/authz_cache.h"
+#include "network/server_context.h"
+#include "network/chunk_stream.h"
+#include "network/http_router.h"
+
+#include <cerrno>
+#include <limits>
+#include <cstdint>
 #include <vector>
+#include <cstdlib>
 #include <iostream>
 #include <algorithm>
 #include <boost/json.hpp>
@@ -30,37 +43,10 @@ std::string dbase_handler::time_with_timezone()
     return time;
 }
 
-//Open PGConnection
-PGconn *dbase_handler::open_connection(std::string &msg)
+//Run named statement from dbase_statements as prepared statement
+PGresult *dbase_handler::statement_exec(PGconn *conn_ptr, const std::string &name, const char * const *param_values)
 {
-    PGconn* conn_ptr {NULL};
-    const std::string& UA_DB_NAME {params_.at("UA_DB_NAME").as_string().c_str()};
-    const std::string& UA_DB_HOST {params_.at("UA_DB_HOST").as_string().c_str()};
-    const std::string& UA_DB_PORT {params_.at("UA_DB_PORT").as_string().c_str()};
-    const std::string& UA_DB_USER {params_.at("UA_DB_USER").as_string().c_str()};
-    const std::string& UA_DB_PASS {params_.at("UA_DB_PASS").as_string().c_str()};
-
-    boost::system::error_code ec;
-    boost::asio::ip::tcp::resolver r {io_};
-    const auto& ep_list {r.resolve(UA_DB_HOST,UA_DB_PORT,ec)};
-    if(ec){
-        msg=ec.message();
-        return nullptr;
-    }
-    boost::asio::ip::tcp::endpoint ep {*ep_list.begin()};
-    std::string conninfo {(boost::format("postgresql://%s:%s@%s:%d/%s?connect_timeout=10")
-        % UA_DB_USER
-        % UA_DB_PASS
-        % ep.address().to_string()
-        % ep.port()
-        % UA_DB_NAME).str()};
-
-    conn_ptr=PQconnectdb(conninfo.c_str());
-    if(PQstatus(conn_ptr)!=CONNECTION_OK){
-        msg=std::string {PQerrorMessage(conn_ptr)};
-        return nullptr;
-    }
-    return conn_ptr;
+    return context_.dbase_pool_ptr->statement_exec(conn_ptr,name,param_values);
 }
 
 //Init tables if empty or not exists
@@ -268,9 +254,8 @@ bool dbase_handler::init_default_rps(PGconn *conn_ptr, std::string &msg)
 bool dbase_handler::is_rp_duplicate(PGconn *conn_ptr, const std::string &name, std::string &msg)
 {
     PGresult* res_ptr {NULL};
-    const std::string& query {"SELECT * FROM roles_permissions WHERE name=$1"};
     const char* param_values[] {name.c_str()};
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+    res_ptr=statement_exec(conn_ptr,"rp_get_by_name",param_values);
     if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
         msg=std::string {PQresultErrorMessage(res_ptr)};
         PQclear(res_ptr);
@@ -291,9 +276,8 @@ bool dbase_handler::is_rp_duplicate(PGconn *conn_ptr, const std::string &name, s
 bool dbase_handler::is_rp_exists(PGconn *conn_ptr, const std::string &rp_uid, std::string &msg)
 {
     PGresult* res_ptr {NULL};
-    const std::string& query {"SELECT * FROM roles_permissions WHERE id=$1"};
     const char* param_values[] {rp_uid.c_str()};
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+    res_ptr=statement_exec(conn_ptr,"rp_get",param_values);
     if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
         msg=std::string {PQresultErrorMessage(res_ptr)};
         PQclear(res_ptr);
@@ -315,9 +299,8 @@ bool dbase_handler::is_rp_exists(PGconn *conn_ptr, const std::string &rp_uid, st
 bool dbase_handler::is_user_exists(PGconn *conn_ptr, const std::string &user_uid, std::string &msg)
 {
     PGresult* res_ptr {NULL};
-    const std::string& query {"SELECT * FROM users WHERE id=$1"};
     const char* param_values[] {user_uid.c_str()};
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+    res_ptr=statement_exec(conn_ptr,"user_get",param_values);
     if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
         msg=std::string {PQresultErrorMessage(res_ptr)};
         PQclear(res_ptr);
@@ -335,139 +318,333 @@ bool dbase_handler::is_user_exists(PGconn *conn_ptr, const std::string &user_uid
     return true;
 }
 
-//Check if user authorized
-bool dbase_handler::is_authorized(PGconn *conn_ptr, const std::string &user_uid, const std::string &rp_ident, std::string &msg)
+//Build postgres text[] literal, items quoted and escaped
+std::string dbase_handler::text_array_literal(const std::vector<std::string> &items)
+{
+    std::string literal {"{"};
+    for(std::size_t i=0;i<items.size();++i){
+        if(i){
+            literal+=",";
+        }
+        literal+="\"";
+        for(const char& c:items[i]){
+            if(c=='"' || c=='\\'){
+                literal+="\\";
+            }
+            literal+=c;
+        }
+        literal+="\"";
+    }
+    literal+="}";
+    return literal;
+}
+
+//Split rp_ident into rp_uids or names, separated by space ('%20' in url)
+std::vector<std::string> dbase_handler::rp_idents_split(const std::string &rp_ident)
+{
+    std::vector<std::string> rp_idents {};
+    const std::string& rp_ident_ {boost::replace_all_copy(rp_ident,"%20"," ")};
+    boost::split(rp_idents,rp_ident_,boost::is_any_of(" "),boost::token_compress_on);
+    rp_idents.erase(std::remove(rp_idents.begin(),rp_idents.end(),std::string {}),rp_idents.end());
+    return rp_idents;
+}
+
+//Mark authz_engine snapshot and decision cache stale after write to rp, relationship or urp tables
+void dbase_handler::authz_changed()
+{
+    if(context_.authz_engine_ptr){
+        context_.authz_engine_ptr->engine_invalidate();
+    }
+    if(context_.authz_cache_ptr){
+        context_.authz_cache_ptr->cache_invalidate();
+    }
+}
+
+//authz_engine first, its snapshot is exact while current, then decision cache
+authz_result dbase_handler::authz_memory_get(const std::string &user_uid, const std::vector<std::string> &rp_idents, std::string &key, std::uint64_t &generation)
+{
+    if(context_.authz_engine_ptr){
+        const authz_result& result {context_.authz_engine_ptr->is_authorized(user_uid,rp_idents)};
+        if(result!=authz_result::unknown){
+            return result;
+        }
+    }
+    if(context_.authz_cache_ptr){
+        //generation before lookup, a write while SQL runs makes the stored decision unusable
+        generation=context_.authz_cache_ptr->generation_get();
+        key=authz_cache::key_make(user_uid,rp_idents);
+        return context_.authz_cache_ptr->decision_get(key);
+    }
+    return authz_result::unknown;
+}
+
+//Keep decision computed by SQL
+void dbase_handler::authz_memory_put(const std::string &key, std::uint64_t generation, bool allowed)
+{
+    if(context_.authz_cache_ptr && !key.empty()){
+        context_.authz_cache_ptr->decision_put(key,generation,allowed);
+    }
+}
+
+//Decide in one round trip, error counts as not authorized and is not cached
+bool dbase_handler::authz_sql_get(PGconn *conn_ptr, const std::string &user_uid, const std::vector<std::string> &rp_idents,
+                                  const std::string &key, std::uint64_t generation, std::string &msg)
 {
     PGresult* res_ptr {NULL};
-    std::vector<std::string> rp_uids {};
-    {//get all rp_uid for user_uid
-        const std::string& query {"SELECT role_permission_id FROM users_roles_permissions WHERE user_id=$1"};
-        const char* param_values[] {user_uid.c_str()};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
-        if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
-            PQclear(res_ptr);
+    const std::string& idents {text_array_literal(rp_idents)};
+    const char* param_values[] {user_uid.c_str(),idents.c_str()};
+    res_ptr=statement_exec(conn_ptr,"authz_check",param_values);
+    if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
+        msg=std::string {PQresultErrorMessage(res_ptr)};
+        PQclear(res_ptr);
+        return false;
+    }
+    const bool& authorized {PQntuples(res_ptr) && std::string {PQgetvalue(res_ptr,0,0)}=="t"};
+    PQclear(res_ptr);
+    authz_memory_put(key,generation,authorized);
+    return authorized;
+}
+
+//Check if user authorized, answered from memory when possible
+bool dbase_handler::is_authorized(PGconn *conn_ptr, const std::string &user_uid, const std::string &rp_ident, std::string &msg)
+{
+    const std::vector<std::string>& rp_idents {rp_idents_split(rp_ident)};
+    if(rp_idents.empty()){
+        return false;
+    }
+    std::string key {};
+    std::uint64_t generation {0};
+    {//answer from memory
+        const authz_result& result {authz_memory_get(user_uid,rp_idents,key,generation)};
+        if(result!=authz_result::unknown){
+            return result==authz_result::allow;
+        }
+    }
+    return authz_sql_get(conn_ptr,user_uid,rp_idents,key,generation,msg);
+}
+
+//Parse int query value, false on junk or overflow
+bool dbase_handler::number_parse(const std::string &text, int &value)
+{
+    if(text.empty()){
+        return false;
+    }
+    char* end {NULL};
+    errno=0;
+    const long& parsed {std::strtol(text.c_str(),&end,10)};
+    if(*end!='\0' || errno==ERANGE || parsed<0 || parsed>std::numeric_limits<int>::max()){
+        return false;
+    }
+    value=static_cast<int>(parsed);
+    return true;
+}
+
+//Take limit, offset and cursor out of query_map
+bool dbase_handler::paging_parse(std::map<std::string, std::string> &query_map, std::size_t keys_count, int &limit, int &offset,
+                                 std::vector<std::string> &cursor_keys, std::string &msg)
+{
+    const auto& limit_it {query_map.find("limit")};
+    if(limit_it!=query_map.end()){
+        if(!number_parse(limit_it->second,limit) || !limit){
+            msg="invalid limit";
             return false;
         }
-        const int& rows {PQntuples(res_ptr)};
-        if(!rows){
-            PQclear(res_ptr);
+        query_map.erase(limit_it);
+    }
+    const auto& offset_it {query_map.find("offset")};
+    if(offset_it!=query_map.end()){
+        if(!number_parse(offset_it->second,offset)){
+            msg="invalid offset";
             return false;
         }
-        for(int r=0;r<rows;++r){
-            const std::string& rp_uid {PQgetvalue(res_ptr,r,0)};
-            rp_uids.push_back(rp_uid);
+        query_map.erase(offset_it);
+    }
+    const auto& cursor_it {query_map.find("cursor")};
+    if(cursor_it!=query_map.end()){
+        if(!dbase_cursor::cursor_decode(cursor_it->second,keys_count,cursor_keys)){
+            msg="invalid cursor";
+            return false;
         }
-        PQclear(res_ptr);
+        //cursor replaces offset
+        offset=0;
+        query_map.erase(cursor_it);
+    }
+    return true;
+}
 
-        {//check if UAuthAdmin role
-            const std::string admin_rp_uid {uath_admin_rp_uid_get(conn_ptr)};
-            const auto& it {std::find(rp_uids.begin(),rp_uids.end(),admin_rp_uid)};
-            if(it!=rp_uids.end()){
-                return true;
-            }
-        }
+//Parse limit and offset without taking them out of query_map
+bool dbase_handler::paging_check(const std::map<std::string, std::string> &query_map, int &limit, int &offset, std::string &msg)
+{
+    const auto& limit_it {query_map.find("limit")};
+    if(limit_it!=query_map.end() && (!number_parse(limit_it->second,limit) || !limit)){
+        msg="invalid limit";
+        return false;
     }
-    {//get all rp_uids recursive
-        rp_uid_recursive_get(conn_ptr,rp_uids);
+    const auto& offset_it {query_map.find("offset")};
+    if(offset_it!=query_map.end() && !number_parse(offset_it->second,offset)){
+        msg="invalid offset";
+        return false;
     }
-    {//check if authorized
-        boost::regex re {"^([0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{12})$"};
-        boost::smatch match;
-        if(!boost::regex_match(rp_ident,match,re)){
-            std::vector<std::string> rp_names {};
-            boost::split(rp_names,rp_ident,boost::is_any_of("%20"),boost::token_compress_on);
-
-            std::vector<std::string> rp_uids_names {};
-            for(const std::string& rp_name: rp_names){
-                const std::string& query {"SELECT id FROM roles_permissions WHERE name=$1"};
-                const char* param_values[] {rp_name.c_str()};
-                res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
-                if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
-                    PQclear(res_ptr);
-                    return false;
-                }
-                const int& rows {PQntuples(res_ptr)};
-                if(!rows){
-                    PQclear(res_ptr);
-                    return false;
-                }
-                for(int r=0;r<rows;++r){
-                    const std::string& rp_uid_name {PQgetvalue(res_ptr,r,0)};
-                    rp_uids_names.push_back(rp_uid_name.c_str());
-                }
-                PQclear(res_ptr);
+    return true;
+}
+
+//Append value and return its placeholder
+std::string dbase_handler::param_bind(std::vector<std::string> &values, const std::string &value)
+{
+    values.push_back(value);
+    return "$" + std::to_string(values.size());
+}
+
+//Append page members up to "items":
+void dbase_handler::page_open(int limit, int offset, int count, int total, const boost::json::value *next_cursor_ptr, std::string &out)
+{
+    out+=(boost::format("{\"limit\":%d,\"offset\":%d,\"count\":%d,\"total\":%d")
+          % limit
+          % offset
+          % count
+          % total).str();
+    if(next_cursor_ptr){
+        out+=",\"next_cursor\":" + boost::json::serialize(*next_cursor_ptr);
+    }
+    out+=",\"items\":";
+}
+
+//Send query in single-row mode and write rows to stream as they arrive
+db_status dbase_handler::rows_stream(PGconn *conn_ptr, const char *query, const std::vector<const char *> &param_values, chunk_stream *stream_ptr,
+                                     const std::string &head, int limit, const std::vector<std::string> &cursor_columns, std::string &msg)
+{
+    if(!PQsendQueryParams(conn_ptr,query,static_cast<int>(param_values.size()),NULL,param_values.data(),NULL,NULL,0)){
+        msg=std::string {PQerrorMessage(conn_ptr)};
+        return db_status::fail;
+    }
+    PQsetSingleRowMode(conn_ptr);
+
+    db_status status_ {db_status::success};
+    bool cancelled {false};
+    int rows {0};
+    std::string chunk {};
+    std::vector<std::string> cursor_keys (cursor_columns.size());
+    //single-row results of one query share column metadata
+    std::unique_ptr<dbase_json_encoder> encoder_ptr {nullptr};
+    const auto& chunk_push {[&](){
+        //waits while session queue is full, false when the client is gone
+        if(!stream_ptr->chunk_push(std::move(chunk))){
+            PGcancel* cancel_ptr {PQgetCancel(conn_ptr)};
+            if(cancel_ptr){
+                char errbuf[256];
+                PQcancel(cancel_ptr,errbuf,sizeof(errbuf));
+                PQfreeCancel(cancel_ptr);
             }
-            const bool contains_all {std::all_of(rp_uids_names.begin(),rp_uids_names.end(),[&](const std::string& rp_uid){
-                    const auto& it {std::find(rp_uids.begin(),rp_uids.end(),rp_uid)};
-                    return (it!=rp_uids.end());
-                })};
-            return contains_all;
+            cancelled=true;
+            msg="stream cancelled";
+            status_=db_status::fail;
         }
-        else{
-            const auto& it {std::find(rp_uids.begin(),rp_uids.end(),rp_ident)};
-            if(it!=rp_uids.end()){
-                return true;
+        chunk.clear();
+    }};
+
+    PGresult* res_ptr {NULL};
+    while((res_ptr=PQgetResult(conn_ptr))!=NULL){
+        if(cancelled){//drain until connection is idle again
+            PQclear(res_ptr);
+            continue;
+        }
+        switch(PQresultStatus(res_ptr)){
+        case PGRES_SINGLE_TUPLE:{
+            if(!encoder_ptr){
+                encoder_ptr.reset(new dbase_json_encoder {res_ptr});
+            }
+            chunk+=rows ? "," : head;
+            encoder_ptr->row_write(res_ptr,0,chunk);
+            for(std::size_t i=0;i<cursor_columns.size();++i){
+                cursor_keys[i]=PQgetvalue(res_ptr,0,PQfnumber(res_ptr,cursor_columns[i].c_str()));
+            }
+            ++rows;
+            if(chunk.size()>=context_.stream_chunk_size){
+                chunk_push();
+            }
+            break;
+        }
+        case PGRES_TUPLES_OK:{//end of rows
+            if(!rows){
+                status_=db_status::not_found;
+                break;
+            }
+            chunk+="],\"count\":" + std::to_string(rows);
+            if(!cursor_columns.empty()){//full page, more rows may follow
+                const boost::json::value& next_cursor {rows==limit ? boost::json::value(dbase_cursor::cursor_encode(cursor_keys)) :
+                                                                     boost::json::value(nullptr)};
+                chunk+=",\"next_cursor\":" + boost::json::serialize(next_cursor);
             }
+            chunk+="}";
+            chunk_push();
+            break;
         }
+        default:
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            status_=db_status::fail;
+            break;
+        }
+        PQclear(res_ptr);
     }
-    return false;
+    //no-op unless a chunk went out, failed drops the last chunk so the client sees a truncated body
+    stream_ptr->stream_finish(status_!=db_status::success);
+    return status_;
 }
 
-//Get total urp
-int dbase_handler::urp_total_get(PGconn *conn_ptr)
+//Get single count(*) value, 0 on error as before
+int dbase_handler::count_get(PGconn *conn_ptr, const std::string &name, const char * const *param_values)
 {
-    PGresult* res_ptr {NULL};
-    const std::string& query {"SELECT * FROM users_roles_permissions"};
-    res_ptr=PQexec(conn_ptr,query.c_str());
-    if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
+    PGresult* res_ptr {statement_exec(conn_ptr,name,param_values)};
+    if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK || !PQntuples(res_ptr) || PQgetisnull(res_ptr,0,0)){
         PQclear(res_ptr);
         return 0;
     }
-
-    const int& rows {PQntuples(res_ptr)};
+    const int& count {static_cast<int>(std::strtoll(PQgetvalue(res_ptr,0,0),NULL,10))};
     PQclear(res_ptr);
-    return rows;
+    return count;
 }
 
-//Get total rps
-int dbase_handler::rp_total_get(PGconn *conn_ptr)
+//Get unfiltered table total, from table_counters when enabled
+int dbase_handler::table_total_get(PGconn *conn_ptr, const std::string &table, const std::string &name)
 {
-    PGresult* res_ptr {NULL};
-    const std::string& query {"SELECT * FROM roles_permissions"};
-    res_ptr=PQexec(conn_ptr,query.c_str());
-    if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
+    if(context_.totals_from_counters){
+        const char* param_values[] {table.c_str()};
+        PGresult* res_ptr {statement_exec(conn_ptr,"counter_get",param_values)};
+        if(PQresultStatus(res_ptr)==PGRES_TUPLES_OK && PQntuples(res_ptr)){
+            const int& count {static_cast<int>(std::strtoll(PQgetvalue(res_ptr,0,0),NULL,10))};
+            PQclear(res_ptr);
+            return count;
+        }
         PQclear(res_ptr);
-        return 0;
+        //counters not installed, exact count instead
     }
+    return count_get(conn_ptr,name,NULL);
+}
 
-    const int& rows {PQntuples(res_ptr)};
-    PQclear(res_ptr);
-    return rows;
+//Get total urp
+int dbase_handler::urp_total_get(PGconn *conn_ptr)
+{
+    return table_total_get(conn_ptr,"users_roles_permissions","urp_total_get");
+}
+
+//Get total rps
+int dbase_handler::rp_total_get(PGconn *conn_ptr)
+{
+    return table_total_get(conn_ptr,"roles_permissions","rp_total_get");
 }
 
 //Get total users
 int dbase_handler::user_total_get(PGconn *conn_ptr)
 {
-    PGresult* res_ptr {NULL};
-    const std::string& query {"SELECT * FROM users"};
-    res_ptr=PQexec(conn_ptr,query.c_str());
-    if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
-        PQclear(res_ptr);
-        return 0;
-    }
-
-    const int& rows {PQntuples(res_ptr)};
-    PQclear(res_ptr);
-    return rows;
+    return table_total_get(conn_ptr,"users","user_total_get");
 }
 
 //Get UAuthAdmin rp_uid
 std::string dbase_handler::uath_admin_rp_uid_get(PGconn *conn_ptr)
 {
     PGresult* res_ptr {NULL};
-    const std::string& query {"SELECT id FROM roles_permissions WHERE name=$1"};
     const char* param_values[] {"UAuthAdmin"};
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+    res_ptr=statement_exec(conn_ptr,"rp_uid_get_by_name",param_values);
     if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
         PQclear(res_ptr);
         return std::string {};
@@ -483,47 +660,11 @@ std::string dbase_handler::uath_admin_rp_uid_get(PGconn *conn_ptr)
     return rp_uid;
 }
 
-//Recursive get all low_level rp_uids by top_level rp_uid
-void dbase_handler::rp_uid_recursive_get(PGconn *conn_ptr, std::vector<std::string>& rp_uids)
-{
-    PGresult* res_ptr {NULL};
-    const std::string& query {"WITH RECURSIVE rp_list AS ("
-                                              "SELECT child_id, parent_id "
-                                              "FROM roles_permissions_relationship "
-                                               "WHERE parent_id IN ($1) "
-                                               "UNION "
-                                               "SELECT rpr.child_id, rpr.parent_id "
-                                               "FROM roles_permissions_relationship rpr "
-                                               "JOIN rp_list on rp_list.child_id = rpr.parent_id"
-                                               ") SELECT DISTINCT child_id FROM rp_list"};
-
-    std::vector<const char*> param_values {};
-    param_values.resize(rp_uids.size());
-    std::transform(rp_uids.begin(),rp_uids.end(),param_values.begin(),[](const std::string& item){
-        return item.c_str();
-    });
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values.data(),NULL,NULL,0);
-    if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
-        PQclear(res_ptr);
-        return;
-    }
-    const int& rows {PQntuples(res_ptr)};
-    if(rows){
-        for(int r=0;r<rows;++r){
-            const char* rp_uid {PQgetvalue(res_ptr,r,0)};
-            rp_uids.push_back(rp_uid);
-        }
-    }
-    PQclear(res_ptr);
-    return;
-}
-
 bool dbase_handler::rp_uids_child_get(PGconn *conn_ptr, const std::string &rp_uid, std::vector<std::string> &child_uids, std::string &msg)
 {
     PGresult* res_ptr {NULL};
-    const std::string& query {"SELECT child_id FROM roles_permissions_relationship WHERE parent_id=$1"};
     const char* param_values[] {rp_uid.c_str()};
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+    res_ptr=statement_exec(conn_ptr,"rp_child_uids_get",param_values);
     if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
         msg=std::string {PQresultErrorMessage(res_ptr)};
         PQclear(res_ptr);
@@ -547,9 +688,8 @@ bool dbase_handler::rp_uids_child_get(PGconn *conn_ptr, const std::string &rp_ui
 bool dbase_handler::rp_uids_parent_get(PGconn *conn_ptr, const std::string &rp_uid, std::vector<std::string> &parent_uids, std::string &msg)
 {
     PGresult* res_ptr {NULL};
-    const std::string& query {"SELECT parent_id FROM roles_permissions_relationship WHERE child_id=$1"};
     const char* param_values[] {rp_uid.c_str()};
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+    res_ptr=statement_exec(conn_ptr,"rp_parent_uids_get",param_values);
     if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
         msg=std::string {PQresultErrorMessage(res_ptr)};
         PQclear(res_ptr);
@@ -570,50 +710,18 @@ bool dbase_handler::rp_uids_parent_get(PGconn *conn_ptr, const std::string &rp_u
     return true;
 }
 
-//Get all first_low_level rp_objects by top_level rp_uid
-void dbase_handler::rp_children_get(PGconn *conn_ptr, const std::string &rp_uid, boost::json::array &rp_objs)
+//Get all first_low_level rp_objects by top_level rp_uid as json array
+void dbase_handler::rp_children_get(PGconn *conn_ptr, const std::string &rp_uid, std::string &rp_objs)
 {
-    PGresult* res_ptr {NULL};
-    const std::string& query {"SELECT child_id from roles_permissions_relationship WHERE parent_id=$1"};
     const char* param_values[]{rp_uid.c_str()};
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+    PGresult* res_ptr {statement_exec(conn_ptr,"rp_children_get",param_values)};
     if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
         PQclear(res_ptr);
+        rp_objs+="[]";
         return;
     }
-    const int& rows {PQntuples(res_ptr)};
-    if(!rows){
-        PQclear(res_ptr);
-        return;
-    }
-    else{
-        for(int r=0;r<rows;++r){
-            const std::string rp_uid {PQgetvalue(res_ptr,r,0)};
-            const std::string& query {"SELECT * FROM roles_permissions WHERE id=$1"};
-            const char* param_values[] {rp_uid.c_str()};
-            PGresult* res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
-            if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
-                PQclear(res_ptr);
-                continue;
-            }
-
-            const int& rows {PQntuples(res_ptr)};
-            const int& columns {PQnfields(res_ptr)};
-            boost::json::object rp_ {};
-
-            for(int r=0;r < rows;++r){
-                boost::json::object rp_ {};
-                for(int c=0;c < columns;++c){
-                    const char* key {PQfname(res_ptr,c)};
-                    const char* value {PQgetvalue(res_ptr,r,c)};
-                    const int& is_null {PQgetisnull(res_ptr,r,c)};
-                    rp_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-                }
-                rp_objs.push_back(rp_);
-            }
-            PQclear(res_ptr);
-        }
-    }
+    dbase_json_encoder {res_ptr}.rows_write(res_ptr,rp_objs);
+    PQclear(res_ptr);
 }
 
 //Get all rp_uids by rp_names
@@ -621,9 +729,8 @@ void dbase_handler::rp_uids_by_rp_names_get(PGconn *conn_ptr, const std::vector<
 {
     PGresult* res_ptr {NULL};
     for(const std::string& rp_name: rp_names){
-        const std::string& query {"SELECT id from roles_permissions WHERE name=$1"};
         const char* param_values[]{rp_name.c_str()};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"rp_uid_get_by_name",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
             PQclear(res_ptr);
             continue;
@@ -645,9 +752,8 @@ void dbase_handler::rp_uids_by_rp_names_get(PGconn *conn_ptr, const std::vector<
 bool dbase_handler::user_uids_by_rp_uid_get(PGconn *conn_ptr, const std::string &rp_uid, std::vector<std::string> &user_uids, std::string &msg)
 {
     PGresult* res_ptr {NULL};
-    const std::string& query {"SELECT user_id FROM users_roles_permissions WHERE role_permission_id=$1"};
     const char* param_values[] {rp_uid.c_str()};
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+    res_ptr=statement_exec(conn_ptr,"urp_user_uids_get",param_values);
     if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
         msg=std::string {PQresultErrorMessage(res_ptr)};
         PQclear(res_ptr);
@@ -666,8 +772,8 @@ bool dbase_handler::user_uids_by_rp_uid_get(PGconn *conn_ptr, const std::string
     return true;
 }
 
-dbase_handler::dbase_handler(const boost::json::object &params, std::shared_ptr<spdlog::logger> logger_ptr)
-    :io_{},params_{params},logger_ptr_{logger_ptr}
+dbase_handler::dbase_handler(const server_context &context)
+    :context_{context}
 {
 }
 
@@ -677,23 +783,24 @@ bool dbase_handler::init_database(std::string &msg)
     if(dbase_handler::is_initiated_){
         return true;
     }
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     if(!conn_ptr){
         return false;
     }
     if(!init_tables(conn_ptr,msg)){
-        PQfinish(conn_ptr);
         return false;
     }
-    PQfinish(conn_ptr);
+    conn.release();
     dbase_handler::is_initiated_=true;
     return true;
 }
 
 //List Of Users with limit and/or offset and filter
-db_status dbase_handler::user_list_get(std::string& users, std::map<std::string, std::string> query_map,const std::string& requester_id,std::string& msg)
+db_status dbase_handler::user_list_get(std::string& users, std::map<std::string, std::string> query_map,const std::string& requester_id,chunk_stream* stream_ptr,std::string& msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -703,114 +810,102 @@ db_status dbase_handler::user_list_get(std::string& users, std::map<std::string,
         const std::string& rp_ident {"user:read"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
 
-    //add limit/offset/filter
+    //add limit/offset/cursor/filter, values are bound as parameters
     int limit {100};
     int offset {0};
-    std::string query {"SELECT * FROM users"};
-    const auto& limit_it {query_map.find("limit")};
-    if(limit_it!=query_map.end()){
-        limit=std::stoi(limit_it->second);
-        query_map.erase(limit_it);
-    }
-    const auto& offset_it {query_map.find("offset")};
-    if(offset_it!=query_map.end()){
-        offset=std::stoi(offset_it->second);
-        query_map.erase(offset_it);
+    std::vector<std::string> cursor_keys {};
+    if(!paging_parse(query_map,2,limit,offset,cursor_keys,msg)){
+        return db_status::fail;
     }
 
-    if(!query_map.empty()){
-        query+=" WHERE";
-        auto it {query_map.begin()};
-        while(it!=query_map.end()){
-            if(it->first=="first_name"){
-                query+=" first_name ILIKE '%" + it->second + "%'";
-            }
-            else if(it->first=="last_name"){
-                query+=" last_name ILIKE '%" + it->second + "%'";
-            }
-            else if(it->first=="email"){
-                query+=" email = '" + it->second + "'";
-            }
-            else if(it->first=="is_blocked"){
-                query+=" is_blocked = '" + it->second + "'";
-            }
-            else if(it->first=="phone_number"){
-                query+=" phone_number ILIKE '%" + it->second + "%'";
-            }
-            else if(it->first=="position"){
-                query+=" position ILIKE '%" + it->second + "%'";
-            }
-            else if(it->first=="gender"){
-                query+=" gender = '" + it->second + "'";
-            }
-            query_map.erase(it++);
-            if(!query_map.empty()){
-                query+=" AND";
-            }
+    std::vector<std::string> values {};
+    std::vector<std::string> conditions {};
+    for(const auto& item: query_map){
+        if(item.first=="first_name"){
+            conditions.push_back("first_name ILIKE '%' || " + param_bind(values,item.second) + " || '%'");
         }
+        else if(item.first=="last_name"){
+            conditions.push_back("last_name ILIKE '%' || " + param_bind(values,item.second) + " || '%'");
+        }
+        else if(item.first=="email"){
+            conditions.push_back("email = " + param_bind(values,item.second));
+        }
+        else if(item.first=="is_blocked"){
+            conditions.push_back("is_blocked = " + param_bind(values,item.second) + "::boolean");
+        }
+        else if(item.first=="phone_number"){
+            conditions.push_back("phone_number ILIKE '%' || " + param_bind(values,item.second) + " || '%'");
+        }
+        else if(item.first=="position"){
+            conditions.push_back("position ILIKE '%' || " + param_bind(values,item.second) + " || '%'");
+        }
+        else if(item.first=="gender"){
+            conditions.push_back("gender = " + param_bind(values,item.second) + "::gender");
+        }
+    }
+    if(!cursor_keys.empty()){//keyset, rows after last (created_at,id) of previous page
+        const std::string& created_at {param_bind(values,cursor_keys.at(0))};
+        const std::string& id {param_bind(values,cursor_keys.at(1))};
+        conditions.push_back("(created_at, id) > (" + created_at + "::timestamptz, " + id + "::uuid)");
     }
 
-    query+=" LIMIT " + std::to_string(limit);
-    query+=" OFFSET " + std::to_string(offset);
+    std::string query {"SELECT * FROM users"};
+    if(!conditions.empty()){
+        query+=" WHERE " + boost::algorithm::join(conditions," AND ");
+    }
+    query+=" ORDER BY created_at, id LIMIT " + param_bind(values,std::to_string(limit));
+    if(cursor_keys.empty()){
+        query+=" OFFSET " + param_bind(values,std::to_string(offset));
+    }
 
-    res_ptr=PQexec(conn_ptr,query.c_str());
+    std::vector<const char*> param_values {};
+    for(const std::string& value: values){
+        param_values.push_back(value.c_str());
+    }
+    if(stream_ptr){//rows go out as chunks while read, total first
+        const int& total {user_total_get(conn_ptr)};
+        const std::string& head {(boost::format("{\"limit\":%d,\"offset\":%d,\"total\":%d,\"items\":[")
+                                  % limit
+                                  % offset
+                                  % total).str()};
+        const db_status& status_ {rows_stream(conn_ptr,query.c_str(),param_values,stream_ptr,head,limit,{"created_at","id"},msg)};
+        return status_;
+    }
+    res_ptr=PQexecParams(conn_ptr,query.c_str(),static_cast<int>(param_values.size()),NULL,param_values.data(),NULL,NULL,0);
     if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
         msg=std::string {PQresultErrorMessage(res_ptr)};
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
         return db_status::fail;
     }
 
     const int& rows {PQntuples(res_ptr)};
     if(!rows){
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
         return db_status::not_found;
     }
-    const int& columns {PQnfields(res_ptr)};
+    //full page, more rows may follow
+    const boost::json::value& next_cursor {rows==limit ? boost::json::value(dbase_cursor::cursor_encode({
+                                               PQgetvalue(res_ptr,rows-1,PQfnumber(res_ptr,"created_at")),
+                                               PQgetvalue(res_ptr,rows-1,PQfnumber(res_ptr,"id"))})) : boost::json::value(nullptr)};
+    const int& total {user_total_get(conn_ptr)};
+    conn.release();
 
-    boost::json::array users_ {};
-    for(int r=0;r < rows;++r){
-        boost::json::object user_ {};
-        for(int c=0;c < columns;++c){
-            const char* key {PQfname(res_ptr,c)};
-            const char* value {PQgetvalue(res_ptr,r,c)};
-            const int& is_null {PQgetisnull(res_ptr,r,c)};
-            if(std::string {key}=="is_blocked"){
-                const std::string& value_ {value};
-                const bool& is_blocked {(value_.empty() || value_=="f") ? false : true};
-                user_.emplace(key,is_blocked);
-            }
-            else{
-                user_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-            }
-        }
-        users_.push_back(user_);
-    }
+    page_open(limit,offset,rows,total,&next_cursor,users);
+    dbase_json_encoder {res_ptr}.rows_write(res_ptr,users);
+    users+='}';
     PQclear(res_ptr);
-    const int& total {user_total_get(conn_ptr)};
-    PQfinish(conn_ptr);
-
-    const boost::json::object out {
-        {"limit",limit},
-        {"offset",offset},
-        {"count",users_.size()},
-        {"total",total},
-        {"items",users_},
-    };
-    users=boost::json::serialize(out);
     return db_status::success;
 }
 
 //Get User Info
 db_status dbase_handler::user_info_get(const std::string &user_uid, std::string &user, const std::string &requester_id, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -820,17 +915,14 @@ db_status dbase_handler::user_info_get(const std::string &user_uid, std::string
         const std::string& rp_ident {"user:read"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
-    const std::string& query {"SELECT * FROM users WHERE id=$1"};
     const char* param_values[] {user_uid.c_str()};
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+    res_ptr=statement_exec(conn_ptr,"user_get",param_values);
     if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
         msg=std::string {PQresultErrorMessage(res_ptr)};
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
         return db_status::fail;
     }
 
@@ -838,37 +930,26 @@ db_status dbase_handler::user_info_get(const std::string &user_uid, std::string
     if(!rows){
         msg="user not found";
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
         return db_status::not_found;
     }
 
-    const int& columns {PQnfields(res_ptr)};
-    boost::json::object user_ {};
-
-    for(int c=0;c < columns;++c){
-        const char* key {PQfname(res_ptr,c)};
-        const char* value {PQgetvalue(res_ptr,0,c)};
-        const int& is_null {PQgetisnull(res_ptr,0,c)};
-        if(std::string {key}=="is_blocked"){
-            const std::string& value_ {value};
-            const bool& is_blocked {(value_.empty() || value_=="f") ? false : true};
-            user_.emplace(key,is_blocked);
-        }
-        else{
-            user_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-        }
-    }
+    std::string user_ {};
+    dbase_json_encoder {res_ptr}.row_write(res_ptr,0,user_);
     PQclear(res_ptr);
-    PQfinish(conn_ptr);
+    conn.release();
 
-    user=boost::json::serialize(user_);
+    user=std::move(user_);
     return db_status::success;
 }
 
 //Get User Assigned Roles And Permissions with limit and/or offset
-db_status dbase_handler::user_rp_get(const std::string &user_uid, const std::string &limit, const std::string &offset, std::string &rps,const std::string &requester_id, std::string &msg)
+db_status dbase_handler::user_rp_get(const std::string &user_uid, int limit, int offset, std::string &rps,const std::string &requester_id, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    const std::string& limit_value {std::to_string(limit)};
+    const std::string& offset_value {std::to_string(offset)};
+
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -878,101 +959,41 @@ db_status dbase_handler::user_rp_get(const std::string &user_uid, const std::str
         const std::string& rp_ident {"role_permission:read"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
     int total {0};
     {//get 'total' users-roles-permissions by user_uid without LIMIT and OFFSET
         const char* param_values[] {user_uid.c_str()};
-        const std::string& query {"SELECT * FROM users_roles_permissions WHERE user_id=$1"};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(), 1,NULL,param_values,NULL,NULL,0);
-        if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
-            PQclear(res_ptr);
-        }
-        total=PQntuples(res_ptr);
-        PQclear(res_ptr);
-    }
-
-    const char* param_values[] {user_uid.c_str()};
-    std::string query {"SELECT role_permission_id FROM users_roles_permissions WHERE user_id=$1"};
-    if(!limit.empty()){
-        query += " LIMIT " + limit;
-    }
-    if(!offset.empty()){
-        query += " OFFSET " + offset;
+        total=count_get(conn_ptr,"urp_total_by_user_get",param_values);
     }
 
-    res_ptr=PQexecParams(conn_ptr,query.c_str(), 1,NULL,param_values,NULL,NULL,0);
+    //limit 0 binds as NULL, all assigned roles and permissions
+    const char* param_values[] {user_uid.c_str(),
+                                limit ? limit_value.c_str() : NULL,
+                                offset_value.c_str()};
+    res_ptr=statement_exec(conn_ptr,"urp_rps_page_get",param_values);
     if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
         msg=std::string {PQresultErrorMessage(res_ptr)};
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
         return db_status::fail;
     }
 
-    boost::json::array rps_ {};
-    const int& rows {PQntuples(res_ptr)};
-    if(!rows){
-        const boost::json::object& out {
-            {"limit",limit.empty() ? 100 : std::stoi(limit)},
-            {"offset",offset.empty() ? 0 : std::stoi(offset)},
-            {"count",rps_.size()},
-            {"total",total},
-            {"items",rps_}
-        };
-        PQclear(res_ptr);
-        PQfinish(conn_ptr);
-        rps=boost::json::serialize(out);
-        return db_status::success;
-    }
-    else{
-        std::vector<std::string> rp_ids {};
-        for(int r=0;r<rows;++r){
-            const std::string& rp_id {PQgetvalue(res_ptr,r,0)};
-            rp_ids.push_back(rp_id);
-        }
-        for(const std::string& rp_id: rp_ids){
-            const std::string& query {"SELECT * FROM roles_permissions WHERE id=$1"};
-            const char* param_values[] {rp_id.c_str()};
-            res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
-            if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
-                PQclear(res_ptr);
-                continue;
-            }
-            const int& rows {PQntuples(res_ptr)};
-            const int& columns {PQnfields(res_ptr)};
-            boost::json::object rp_ {};
-            for(int r=0;r<rows;++r){
-                for(int c=0;c < columns;++c){
-                    const char* key {PQfname(res_ptr,c)};
-                    const char* value {PQgetvalue(res_ptr,r,c)};
-                    const int& is_null {PQgetisnull(res_ptr,r,c)};
-                    rp_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-                }
-            }
+    conn.release();
 
-            rps_.push_back(rp_);
-            PQclear(res_ptr);
-        }
-    }
-    PQfinish(conn_ptr);
-
-    const boost::json::object& out {
-        {"limit",limit.empty() ? 100 : std::stoi(limit)},
-        {"offset",offset.empty() ? 0 : std::stoi(offset)},
-        {"count",rps_.size()},
-        {"total",total},
-        {"items",rps_}
-    };
-    rps=boost::json::serialize(out);
+    //page rows are already joined with roles_permissions
+    page_open(limit,offset,PQntuples(res_ptr),total,nullptr,rps);
+    dbase_json_encoder {res_ptr}.rows_write(res_ptr,rps);
+    rps+='}';
+    PQclear(res_ptr);
     return db_status::success;
 }
 
 //Update User
 db_status dbase_handler::user_info_put(const std::string &user_uid, const std::string &user, const std::string &requester_id, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -982,7 +1003,6 @@ db_status dbase_handler::user_info_put(const std::string &user_uid, const std::s
         const std::string& rp_ident {"user:update"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
@@ -994,6 +1014,10 @@ db_status dbase_handler::user_info_put(const std::string &user_uid, const std::s
             msg="user not valid, error: " + ec.message();
             return db_status::fail;
         }
+        if(!user_.is_object()){
+            msg="user not valid, object expected";
+            return db_status::fail;
+        }
         user_obj=user_.as_object();
 
         std::set<std::string> fields_set {"first_name","last_name","email","is_blocked","phone_number","position","gender","location_id","ou_id"};
@@ -1027,64 +1051,44 @@ db_status dbase_handler::user_info_put(const std::string &user_uid, const std::s
     const std::string& updated_at    {time_with_timezone()};
 
     {//update user
-        const std::string& query {"UPDATE users SET first_name=$1,last_name=$2,email=$3,is_blocked=$4,updated_at=$5,"
-                                                "phone_number=$6,position=$7,gender=$8,location_id=$9,ou_id=$10 WHERE id=$11"};
         const char* param_values[] {first_name,last_name,email,is_blocked.c_str(),updated_at.c_str(),
                                                       phone_number,position,gender,location_id,ou_id,user_uid.c_str()};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),11,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"user_update",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_COMMAND_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
         PQclear(res_ptr);
     }
 
     {//get updated user back
-        const std::string& query {"SELECT * FROM users WHERE id=$1"};
         const char* param_values[] {user_uid.c_str()};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"user_get",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
         const int& rows {PQntuples(res_ptr)};
         if(!rows){
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::not_found;
         }
 
-        const int& columns {PQnfields(res_ptr)};
-        boost::json::object user_ {};
-
-        for(int c=0;c < columns;++c){
-            const char* key {PQfname(res_ptr,c)};
-            const char* value {PQgetvalue(res_ptr,0,c)};
-            const int& is_null {PQgetisnull(res_ptr,0,c)};
-            if(std::string {key}=="is_blocked"){
-                const std::string& value_ {value};
-                const bool& is_blocked {(value_.empty() || value_=="f") ? false : true};
-                user_.emplace(key,is_blocked);
-            }
-            else{
-                user_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-            }
-        }
+        std::string user_ {};
+        dbase_json_encoder {res_ptr}.row_write(res_ptr,0,user_);
         PQclear(res_ptr);
-        msg=boost::json::serialize(user_);
+        msg=std::move(user_);
     }
-    PQfinish(conn_ptr);
     return db_status::success;
 }
 
 //Create User
 db_status dbase_handler::user_info_post(const std::string &user, const std::string &requester_id, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -1094,7 +1098,6 @@ db_status dbase_handler::user_info_post(const std::string &user, const std::stri
         const std::string& rp_ident {"user:create"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
@@ -1107,6 +1110,10 @@ db_status dbase_handler::user_info_post(const std::string &user, const std::stri
             msg="user not valid, error: " + ec.message();
             return db_status::fail;
         }
+        if(!user_.is_object()){
+            msg="user not valid, object expected";
+            return db_status::fail;
+        }
         user_obj=user_.as_object();
 
         std::set<std::string> fields_set {"id","first_name","last_name","email","phone_number","position","gender","location_id","ou_id"};
@@ -1141,63 +1148,42 @@ db_status dbase_handler::user_info_post(const std::string &user, const std::stri
         const std::string& updated_at {time_with_timezone()};
         const std::string& is_blocked {std::to_string(false)};
 
-        const std::string& query {"INSERT INTO users (id,first_name,last_name,email,created_at,updated_at,is_blocked,phone_number,position,gender,location_id,ou_id)"
-                                                 " VALUES($1,$2,$3,$4,$5,$6,$7,$8,$9,$10,$11,$12)"};
         const char* param_values[] {id,first_name,last_name,email,created_at.c_str(),updated_at.c_str(),is_blocked.c_str(),
                                     phone_number,position,gender,location_id,ou_id};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),12,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"user_insert",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_COMMAND_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
     }
     {//send created user back
         const char* id {user_obj.at("id").as_string().c_str()};;
-        const  std::string&  query  {"SELECT * FROM users WHERE id=$1"};
         const char* param_values[] {id};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"user_get",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
         const int& rows {PQntuples(res_ptr)};
         if(!rows){
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::not_found;
         }
-        const int& columns {PQnfields(res_ptr)};
-
-        boost::json::object user_ {};
-
-        for(int c=0;c < columns;++c){
-            const char* key {PQfname(res_ptr,c)};
-            const char* value {PQgetvalue(res_ptr,0,c)};
-            const int& is_null {PQgetisnull(res_ptr,0,c)};
-            if(std::string {key}=="is_blocked"){
-                const std::string& value_ {value};
-                const bool& is_blocked {(value_.empty() || value_=="f") ? false : true};
-                user_.emplace(key,is_blocked);
-            }
-            else{
-                user_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-            }
-        }
+        std::string user_ {};
+        dbase_json_encoder {res_ptr}.row_write(res_ptr,0,user_);
         PQclear(res_ptr);
-        msg=boost::json::serialize(user_);
+        msg=std::move(user_);
     }
-    PQfinish(conn_ptr);
     return db_status::success;
 }
 
 //Delete User
 db_status dbase_handler::user_info_delete(const std::string &user_uid, const std::string &requester_id, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -1207,28 +1193,26 @@ db_status dbase_handler::user_info_delete(const std::string &user_uid, const std
         const std::string& rp_ident {"user:delete"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
-    const std::string& query {"DELETE FROM users WHERE id=$1"};
     const char* param_values[] {user_uid.c_str()};
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+    res_ptr=statement_exec(conn_ptr,"user_delete",param_values);
     if(PQresultStatus(res_ptr)!=PGRES_COMMAND_OK){
         msg=std::string {PQresultErrorMessage(res_ptr)};
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
         return db_status::fail;
     }
     PQclear(res_ptr);
-    PQfinish(conn_ptr);
+    authz_changed();
     return db_status::success;
 }
 
 //List Of Roles And Permissions with limit and/or offset
-db_status dbase_handler::rp_list_get(std::string &rps, std::map<std::string, std::string> query_map, const std::string &requester_id, std::string &msg)
+db_status dbase_handler::rp_list_get(std::string &rps, std::map<std::string, std::string> query_map, const std::string &requester_id, chunk_stream *stream_ptr, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -1238,97 +1222,83 @@ db_status dbase_handler::rp_list_get(std::string &rps, std::map<std::string, std
         const std::string& rp_ident {"role_permission:read"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
+    //add limit/offset/cursor/filter, values are bound as parameters
     int limit {100};
     int offset {0};
-    std::string query {"SELECT * FROM roles_permissions"};
-    const auto& limit_it {query_map.find("limit")};
-    if(limit_it!=query_map.end()){
-        limit=std::stoi(limit_it->second);
-        query_map.erase(limit_it);
-    }
-    const auto& offset_it {query_map.find("offset")};
-    if(offset_it!=query_map.end()){
-        offset=std::stoi(offset_it->second);
-        query_map.erase(offset_it);
+    std::vector<std::string> cursor_keys {};
+    if(!paging_parse(query_map,1,limit,offset,cursor_keys,msg)){
+        return db_status::fail;
     }
 
-    if(!query_map.empty()){
-        query +=" WHERE";
-        const auto& it {query_map.begin()};
-        if(it->first=="type"){
-            query+=" type = '" + it->second + "'";
+    std::vector<std::string> values {};
+    std::vector<std::string> conditions {};
+    for(const auto& item: query_map){
+        if(item.first=="type"){
+            conditions.push_back("type = " + param_bind(values,item.second) + "::rolepermissiontype");
         }
-        if(it->first=="name"){
-            query +=" name ILIKE '%" + it->second + "%'";
+        else if(item.first=="name"){
+            conditions.push_back("name ILIKE '%' || " + param_bind(values,item.second) + " || '%'");
         }
-        query_map.erase(it);
     }
-
-    if(!query_map.empty()){
-        query +=" AND";
-        const auto& it {query_map.begin()};
-        if(it->first=="type"){
-            query+=" type = '" + it->second + "'";
-        }
-        if(it->first=="name"){
-            query +=" name ILIKE '%" + it->second + "%'";
-        }
-        query_map.erase(it);
+    if(!cursor_keys.empty()){//keyset, rows after last unique name of previous page
+        conditions.push_back("name > " + param_bind(values,cursor_keys.at(0)));
     }
 
-    query+=" LIMIT " + std::to_string(limit);
-    query+=" OFFSET " + std::to_string(offset);
+    std::string query {"SELECT * FROM roles_permissions"};
+    if(!conditions.empty()){
+        query+=" WHERE " + boost::algorithm::join(conditions," AND ");
+    }
+    query+=" ORDER BY name LIMIT " + param_bind(values,std::to_string(limit));
+    if(cursor_keys.empty()){
+        query+=" OFFSET " + param_bind(values,std::to_string(offset));
+    }
 
-    res_ptr=PQexec(conn_ptr,query.c_str());
+    std::vector<const char*> param_values {};
+    for(const std::string& value: values){
+        param_values.push_back(value.c_str());
+    }
+    if(stream_ptr){//rows go out as chunks while read, total first
+        const int& total {rp_total_get(conn_ptr)};
+        const std::string& head {(boost::format("{\"limit\":%d,\"offset\":%d,\"total\":%d,\"items\":[")
+                                  % limit
+                                  % offset
+                                  % total).str()};
+        const db_status& status_ {rows_stream(conn_ptr,query.c_str(),param_values,stream_ptr,head,limit,{"name"},msg)};
+        return status_;
+    }
+    res_ptr=PQexecParams(conn_ptr,query.c_str(),static_cast<int>(param_values.size()),NULL,param_values.data(),NULL,NULL,0);
     if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
         msg=std::string {PQresultErrorMessage(res_ptr)};
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
         return db_status::fail;
     }
 
     const int& rows {PQntuples(res_ptr)};
     if(!rows){
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
         return db_status::not_found;
     }
-    const int& columns {PQnfields(res_ptr)};
-    boost::json::array rps_ {};
+    //full page, more rows may follow
+    const boost::json::value& next_cursor {rows==limit ? boost::json::value(dbase_cursor::cursor_encode({
+                                               PQgetvalue(res_ptr,rows-1,PQfnumber(res_ptr,"name"))})) : boost::json::value(nullptr)};
+    const int& total {rp_total_get(conn_ptr)};
+    conn.release();
 
-    for(int r=0;r < rows;++r){
-        boost::json::object rp_ {};
-        for(int c=0;c < columns;++c){
-            const char* key {PQfname(res_ptr,c)};
-            const char* value {PQgetvalue(res_ptr,r,c)};
-            const int& is_null {PQgetisnull(res_ptr,r,c)};
-            rp_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-        }
-        rps_.push_back(rp_);
-    }
+    page_open(limit,offset,rows,total,&next_cursor,rps);
+    dbase_json_encoder {res_ptr}.rows_write(res_ptr,rps);
+    rps+='}';
     PQclear(res_ptr);
-    const int& total {rp_total_get(conn_ptr)};
-    PQfinish(conn_ptr);
-
-    const boost::json::object& out {
-        {"limit",limit},
-        {"offset",offset},
-        {"count",rps_.size()},
-        {"total",total},
-        {"items",rps_}
-    };
-    rps=boost::json::serialize(out);
     return db_status::success;
 }
 
 //Get Permission Or Role
 db_status dbase_handler::rp_info_get(const std::string &rp_uid, std::string &rp, const std::string &requester_id, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -1338,152 +1308,46 @@ db_status dbase_handler::rp_info_get(const std::string &rp_uid, std::string &rp,
         const std::string& rp_ident {"role_permission:read"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
-    const std::string& query {"SELECT * FROM roles_permissions WHERE id=$1"};
     const char* param_values[] {rp_uid.c_str()};
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+    res_ptr=statement_exec(conn_ptr,"rp_get",param_values);
     if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
         msg=std::string {PQresultErrorMessage(res_ptr)};
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
         return db_status::fail;
     }
 
     const int& rows {PQntuples(res_ptr)};
     if(!rows){
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
         return db_status::not_found;
     }
-    const int& columns {PQnfields(res_ptr)};
-    boost::json::object rp_ {};
-
-    for(int c=0;c < columns;++c){
-        const char* key {PQfname(res_ptr,c)};
-        const char* value {PQgetvalue(res_ptr,0,c)};
-        const int& is_null {PQgetisnull(res_ptr,0,c)};
-        rp_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-    }
+    std::string rp_ {};
+    dbase_json_encoder {res_ptr}.row_write(res_ptr,0,rp_);
     PQclear(res_ptr);
-    PQfinish(conn_ptr);
+    conn.release();
 
-    rp=boost::json::serialize(rp_);
+    rp=std::move(rp_);
     return db_status::success;
 }
 
 //Get Associated Users
-db_status dbase_handler::rp_user_get(const std::string &rp_uid, std::string &users, const std::string &requester_id, std::string &msg)
+db_status dbase_handler::rp_user_get(const std::string &rp_uid, std::string &users, const std::string &requester_id, chunk_stream *stream_ptr, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
-    PGresult* res_ptr {NULL};
-    if(!conn_ptr){
-        return db_status::fail;
-    }
-    {//check if authorized
-        std::string msg {};
-        const std::string& rp_ident {"user:read"};
-        const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
-        if(!authorized){
-            PQfinish(conn_ptr);
-            return db_status::unauthorized;
-        }
-    }
-    int total {0};
-    {//get 'total' users-roles-permissions by rp_uid without LIMIT and OFFSET
-        const char* param_values[] {rp_uid.c_str()};
-        const std::string& query {"SELECT * FROM users_roles_permissions WHERE role_permission_id=$1"};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(), 1,NULL,param_values,NULL,NULL,0);
-        if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
-            PQclear(res_ptr);
-        }
-        total=PQntuples(res_ptr);
-        PQclear(res_ptr);
-    }
-
-    const char* param_values[] {rp_uid.c_str()};
-    const std::string& query {"SELECT user_id FROM users_roles_permissions WHERE role_permission_id=$1"};
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL, param_values,NULL,NULL,0);
-    if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
-        msg=std::string {PQresultErrorMessage(res_ptr)};
-        PQclear(res_ptr);
-        PQfinish(conn_ptr);
-        return db_status::fail;
-    }
-
-    boost::json::array users_ {};
-    const int& rows {PQntuples(res_ptr)};
-    if(!rows){
-        PQclear(res_ptr);
-        PQfinish(conn_ptr);
-
-        const boost::json::object& out {
-            {"limit",100},
-            {"offset",0},
-            {"count",users_.size()},
-            {"total",total},
-            {"items",users_}
-        };
-        users=boost::json::serialize(out);
-        return db_status::success;
-    }
-    else{
-        std::vector<std::string> user_ids {};
-        for(int r=0;r<rows;++r){
-            const std::string& user_id {PQgetvalue(res_ptr,r,0)};
-            user_ids.push_back(user_id);
-        }
-
-        for(const std::string& user_id: user_ids){
-            const char* param_values[] {user_id.c_str()};
-            const std::string& query {"SELECT * FROM users WHERE id=$1"};
-            res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
-            if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
-                PQclear(res_ptr);
-                continue;
-            }
-
-            const int& rows {PQntuples(res_ptr)};
-            const int& columns {PQnfields(res_ptr)};
-            boost::json::object user_ {};
-            for(int r=0;r<rows;++r){
-                for(int c=0;c < columns;++c){
-                    const char* key {PQfname(res_ptr,c)};
-                    const char* value {PQgetvalue(res_ptr,r,c)};
-                    const int& is_null {PQgetisnull(res_ptr,r,c)};
-                    if(std::string {key}=="is_blocked"){
-                        const std::string& value_ {value};
-                        const bool& is_blocked {(value_.empty() || value_=="f") ? false : true};
-                        user_.emplace(key,is_blocked);
-                    }
-                    else{
-                        user_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-                    }
-                }
-            }
-            users_.push_back(user_);
-            PQclear(res_ptr);
-        }
-    }
-    PQfinish(conn_ptr);
-
-    const boost::json::object& out {
-        {"limit",100},
-        {"offset",0},
-        {"count",users_.size()},
-        {"total",total},
-        {"items",users_}
-    };
-    users=boost::json::serialize(out);
-    return db_status::success;
+    //no limit and offset
+    return rp_user_get(rp_uid,users,0,0,requester_id,stream_ptr,msg);
 }
 
 //Get Associated Users with limit and/or offset and filter
-db_status dbase_handler::rp_user_get(const std::string &rp_uid, std::string &users, const std::string &limit, const std::string &offset, const std::string &requester_id, std::string &msg)
+db_status dbase_handler::rp_user_get(const std::string &rp_uid, std::string &users, int limit, int offset, const std::string &requester_id, chunk_stream *stream_ptr, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    const std::string& limit_value {std::to_string(limit)};
+    const std::string& offset_value {std::to_string(offset)};
+
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -1493,111 +1357,63 @@ db_status dbase_handler::rp_user_get(const std::string &rp_uid, std::string &use
         const std::string& rp_ident {"user:read"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
     int total {0};
     {//get 'total' users-roles-permissions by rp_uid without LIMIT and OFFSET
         const char* param_values[] {rp_uid.c_str()};
-        const std::string& query {"SELECT * FROM users_roles_permissions WHERE role_permission_id=$1"};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(), 1,NULL,param_values,NULL,NULL,0);
-        if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
-            PQclear(res_ptr);
-        }
-        total=PQntuples(res_ptr);
-        PQclear(res_ptr);
-    }
-
-    std::string query {"SELECT user_id FROM users_roles_permissions WHERE role_permission_id=$1"};
-    if(!limit.empty()){
-        query +=" LIMIT " + limit;
-    }
-    if(!offset.empty()){
-        query +=" OFFSET " + offset;
-    }
-
-    const char* param_values[] {rp_uid.c_str()};
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL, param_values,NULL,NULL,0);
+        total=count_get(conn_ptr,"urp_total_by_rp_get",param_values);
+    }
+
+    //limit 0 binds as NULL, all associated users
+    const char* param_values[] {rp_uid.c_str(),
+                                limit ? limit_value.c_str() : NULL,
+                                offset_value.c_str()};
+    if(stream_ptr){//rows go out as chunks while read
+        const std::string& head {(boost::format("{\"limit\":%d,\"offset\":%d,\"total\":%d,\"items\":[")
+                                  % limit
+                                  % offset
+                                  % total).str()};
+        const dbase_statement* statement_ptr {dbase_statements::statement_get("urp_users_page_get")};
+        const std::vector<const char*> values (param_values,param_values+statement_ptr->params);
+        const db_status& status_ {rows_stream(conn_ptr,statement_ptr->sql,values,stream_ptr,head,0,{},msg)};
+        conn.release();
+        if(status_==db_status::not_found){//no associated users is an empty page, not an error
+            const boost::json::object& out {
+                {"limit",limit},
+                {"offset",offset},
+                {"count",0},
+                {"total",total},
+                {"items",boost::json::array {}}
+            };
+            users=boost::json::serialize(out);
+            return db_status::success;
+        }
+        return status_;
+    }
+    res_ptr=statement_exec(conn_ptr,"urp_users_page_get",param_values);
     if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
         msg=std::string {PQresultErrorMessage(res_ptr)};
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
         return db_status::fail;
     }
 
-    boost::json::array users_ {};
-    const int& rows {PQntuples(res_ptr)};
-    if(!rows){
-        PQclear(res_ptr);
-        PQfinish(conn_ptr);
-
-        const boost::json::object& out {
-            {"limit",limit.empty() ? 100 : std::stoi(limit)},
-            {"offset",offset.empty() ? 0 : std::stoi(offset)},
-            {"count",users_.size()},
-            {"total",total},
-            {"items",users_}
-        };
-        users=boost::json::serialize(out);
-        return db_status::success;
-    }
-    else{
-        std::vector<std::string> user_ids {};
-        for(int r=0;r<rows;++r){
-            const std::string& user_id {PQgetvalue(res_ptr,r,0)};
-            user_ids.push_back(user_id);
-        }
-
-        for(const std::string& user_id: user_ids){
-            const char* param_values[] {user_id.c_str()};
-            const std::string& query {"SELECT * FROM users WHERE id=$1"};
-            res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
-            if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
-                PQclear(res_ptr);
-                continue;
-            }
-
-            const int& rows {PQntuples(res_ptr)};
-            const int& columns {PQnfields(res_ptr)};
-            boost::json::object user_ {};
-
-           for(int r=0;r<rows;++r){
-               for(int c=0;c < columns;++c){
-                   const char* key {PQfname(res_ptr,c)};
-                   const char* value {PQgetvalue(res_ptr,r,c)};
-                   const int& is_null {PQgetisnull(res_ptr,r,c)};
-                   if(std::string {key}=="is_blocked"){
-                       const std::string& value_ {value};
-                       const bool& is_blocked {(value_.empty() || value_=="f") ? false : true};
-                       user_.emplace(key,is_blocked);
-                   }
-                   else{
-                       user_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-                   }
-               }
-           }
-            users_.push_back(user_);
-            PQclear(res_ptr);
-        }
-    }
-    PQfinish(conn_ptr);
+    conn.release();
 
-     const boost::json::object& out {
-        {"limit",limit.empty() ? 100 : std::stoi(limit)},
-        {"offset",offset.empty() ? 0 : std::stoi(offset)},
-        {"count",users_.size()},
-        {"total",total},
-        {"items",users_}
-    };
-    users=boost::json::serialize(out);
+    //page rows are already joined with users
+    page_open(limit,offset,PQntuples(res_ptr),total,nullptr,users);
+    dbase_json_encoder {res_ptr}.rows_write(res_ptr,users);
+    users+='}';
+    PQclear(res_ptr);
     return db_status::success;
 }
 
 //Get Permission Or Role Detail
 db_status dbase_handler::rp_rp_detail_get(const std::string &rp_uid, std::string &rp, const std::string &requester_id, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -1607,50 +1423,42 @@ db_status dbase_handler::rp_rp_detail_get(const std::string &rp_uid, std::string
         const std::string& rp_ident {"role_permission:read"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
-    const std::string& query {"SELECT * FROM roles_permissions WHERE id=$1"};
     const char* param_values[] {rp_uid.c_str()};
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+    res_ptr=statement_exec(conn_ptr,"rp_get",param_values);
     if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
         msg=std::string {PQresultErrorMessage(res_ptr)};
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
         return db_status::fail;
     }
 
     const int& rows {PQntuples(res_ptr)};
     if(!rows){
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
         return db_status::fail;
     }
-    const int& columns {PQnfields(res_ptr)};
-    boost::json::object rp_ {};
-    for(int c=0;c < columns;++c){
-        const char* key {PQfname(res_ptr,c)};
-        const char* value {PQgetvalue(res_ptr,0,c)};
-        const int& is_null {PQgetisnull(res_ptr,0,c)};
-        rp_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-    }
+    std::string rp_ {};
+    dbase_json_encoder {res_ptr}.row_open(res_ptr,0,rp_);
+    const std::string& rp_uid_ {PQgetvalue(res_ptr,0,PQfnumber(res_ptr,"id"))};
     PQclear(res_ptr);
 
     //get all first_level children for rp
-    boost::json::array children {};
-    rp_children_get(conn_ptr,rp_.at("id").as_string().c_str(),children);
-    rp_.emplace("children",children);
-    PQfinish(conn_ptr);
+    rp_+=",\"children\":";
+    rp_children_get(conn_ptr,rp_uid_,rp_);
+    rp_+='}';
+    conn.release();
 
-    rp=boost::json::serialize(rp_);
+    rp=std::move(rp_);
     return db_status::success;
 }
 
 //Create Permission Or Role
 db_status dbase_handler::rp_info_post(const std::string &rp, const std::string &requester_id, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -1660,7 +1468,6 @@ db_status dbase_handler::rp_info_post(const std::string &rp, const std::string &
         const std::string& rp_ident {"role_permission:create"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
@@ -1673,6 +1480,10 @@ db_status dbase_handler::rp_info_post(const std::string &rp, const std::string &
             msg="role-permission not valid, error: " + ec.message();
             return db_status::fail;
         }
+        if(!rp_.is_object()){
+            msg="role-permission not valid, object expected";
+            return db_status::fail;
+        }
         rp_obj=rp_.as_object();
 
         std::set<std::string> fields_set {"name","type","description"};
@@ -1700,7 +1511,6 @@ db_status dbase_handler::rp_info_post(const std::string &rp, const std::string &
         const bool& is_duplicate {is_rp_duplicate(conn_ptr,std::string{name},msg)};
         if(is_duplicate){
             msg="role/permission with name: '" + std::string{name} + "' already exists!";
-            PQfinish(conn_ptr);
             return db_status::conflict;
         }
     }
@@ -1710,53 +1520,43 @@ db_status dbase_handler::rp_info_post(const std::string &rp, const std::string &
     const std::string& uuid {boost::uuids::to_string(uuid_)};
 
     {//create role-permission
-        const std::string& query {"INSERT INTO roles_permissions (id,name,type,description) VALUES($1,$2,$3,$4)"};
         const char* param_values[] {uuid.c_str(),name,type,description};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),4,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"rp_insert",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_COMMAND_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
+        PQclear(res_ptr);
+        authz_changed();
     }
     {//send created role-permission back
-        const std::string& query {"SELECT * FROM roles_permissions WHERE id=$1"};
         const char* param_values[] {uuid.c_str()};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"rp_get",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
 
         const int& rows {PQntuples(res_ptr)};
         if(!rows){
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::not_found;
         }
-        const int& columns {PQnfields(res_ptr)};
-        boost::json::object rp_ {};
-
-        for(int c=0;c < columns;++c){
-            const char* key {PQfname(res_ptr,c)};
-            const char* value {PQgetvalue(res_ptr,0,c)};
-            const int& is_null {PQgetisnull(res_ptr,0,c)};
-            rp_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-        }
+        std::string rp_ {};
+        dbase_json_encoder {res_ptr}.row_write(res_ptr,0,rp_);
         PQclear(res_ptr);
-        msg=boost::json::serialize(rp_);
+        msg=std::move(rp_);
     }
-    PQfinish(conn_ptr);
     return db_status::success;
 }
 
 //Update Permission Or Role
 db_status dbase_handler::rp_info_put(const std::string &rp_uid, const std::string &rp, const std::string &requester_id, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -1766,7 +1566,6 @@ db_status dbase_handler::rp_info_put(const std::string &rp_uid, const std::strin
         const std::string& rp_ident {"role_permission:update"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
@@ -1779,6 +1578,10 @@ db_status dbase_handler::rp_info_put(const std::string &rp_uid, const std::strin
             msg="role-permission not valid, error: " + ec.message();
             return db_status::fail;
         }
+        if(!rp_.is_object()){
+            msg="role-permission not valid, object expected";
+            return db_status::fail;
+        }
         rp_obj=rp_.as_object();
 
         std::set<std::string> fields_set {"name","type","description"};
@@ -1803,54 +1606,44 @@ db_status dbase_handler::rp_info_put(const std::string &rp_uid, const std::strin
     const char* description {rp_obj.at("description").is_null() ? nullptr : rp_obj.at("description").as_string().c_str()};
 
     {//update role-permmission
-        const std::string& query {"UPDATE roles_permissions SET name=$1,type=$2,description=$3 WHERE id=$4"};
         const char* param_values[] {name,type,description,rp_uid.c_str()};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),4,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"rp_update",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_COMMAND_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
         PQclear(res_ptr);
+        authz_changed();
     }
 
     {//get updated role-permission back
-        const std::string& query {"SELECT * FROM roles_permissions WHERE id=$1"};
         const char* param_values[] {rp_uid.c_str()};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"rp_get",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
         const int& rows {PQntuples(res_ptr)};
         if(!rows){
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::not_found;
         }
 
-        const int& columns {PQnfields(res_ptr)};
-        boost::json::object rp_ {};
-        for(int c=0;c < columns;++c){
-            const char* key {PQfname(res_ptr,c)};
-            const char* value {PQgetvalue(res_ptr,0,c)};
-            const int& is_null {PQgetisnull(res_ptr,0,c)};
-            rp_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-        }
+        std::string rp_ {};
+        dbase_json_encoder {res_ptr}.row_write(res_ptr,0,rp_);
         PQclear(res_ptr);
-        msg=boost::json::serialize(rp_);   
+        msg=std::move(rp_);   
     }
-    PQfinish(conn_ptr);
     return db_status::success;
 }
 
 //Delete Permission Or Role
 db_status dbase_handler::rp_info_delete(const std::string &rp_uid, const std::string& requester_id,std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -1867,7 +1660,6 @@ db_status dbase_handler::rp_info_delete(const std::string &rp_uid, const std::st
         const std::string& rp_ident {"role_permission:delete"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
@@ -1875,11 +1667,9 @@ db_status dbase_handler::rp_info_delete(const std::string &rp_uid, const std::st
         std::vector<std::string> user_uids {};
         const bool& ok {user_uids_by_rp_uid_get(conn_ptr,rp_uid,user_uids,msg)};
         if(!ok){
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
         if(!user_uids.empty()){
-            PQfinish(conn_ptr);
             const std::string& joined {boost::algorithm::join(user_uids,", ")};
             msg=(boost::format("%s assigned to users %s")
                                 % rp_uid
@@ -1901,28 +1691,26 @@ db_status dbase_handler::rp_info_delete(const std::string &rp_uid, const std::st
         }
         else{
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
     }
-    const std::string& query {"DELETE FROM roles_permissions WHERE id=$1"};
     const char* param_values[] {rp_uid.c_str()};
-    res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+    res_ptr=statement_exec(conn_ptr,"rp_delete",param_values);
     if(PQresultStatus(res_ptr)!=PGRES_COMMAND_OK){
         msg=std::string {PQresultErrorMessage(res_ptr)};
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
         return db_status::fail;
     }
     PQclear(res_ptr);
-    PQfinish(conn_ptr);
+    authz_changed();
     return db_status::success;
 }
 
 //Add Child To Role
 db_status dbase_handler::rp_child_put(const std::string &parent_uid, const std::string &child_uid, const std::string &requester_id, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -1932,64 +1720,52 @@ db_status dbase_handler::rp_child_put(const std::string &parent_uid, const std::
         const std::string& rp_ident {"role_permission:update"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
     {//check if rp exists
         if(!is_rp_exists(conn_ptr,parent_uid,msg) || !is_rp_exists(conn_ptr,child_uid,msg)){
-            PQfinish(conn_ptr);
             return db_status::not_found;
         }
     }
     {//create relationship
         const std::string& created_at {time_with_timezone()};
-        const std::string& query {"INSERT INTO roles_permissions_relationship (created_at,parent_id,child_id) VALUES($1,$2,$3)"};
         const char* param_values[] {created_at.c_str(),parent_uid.c_str(),child_uid.c_str()};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),3,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"rp_child_insert",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_COMMAND_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
         PQclear(res_ptr);
+        authz_changed();
     }
     {//send rp with all children back
-        const std::string& query {"SELECT * FROM roles_permissions WHERE id=$1"};
         const char* param_values[] {parent_uid.c_str()};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"rp_get",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
 
         const int& rows {PQntuples(res_ptr)};
         if(!rows){
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::not_found;
         }
-        const int& columns {PQnfields(res_ptr)};
-        boost::json::object rp_ {};
-
-        for(int c=0;c < columns;++c){
-            const char* key {PQfname(res_ptr,c)};
-            const char* value {PQgetvalue(res_ptr,0,c)};
-            const int& is_null {PQgetisnull(res_ptr,0,c)};
-            rp_.emplace(key,value==NULL ? boost::json::value(nullptr) : value);
-        }
+        std::string rp_ {};
+        dbase_json_encoder {res_ptr}.row_open(res_ptr,0,rp_);
+        const std::string& rp_uid_ {PQgetvalue(res_ptr,0,PQfnumber(res_ptr,"id"))};
         PQclear(res_ptr);
 
         //get all first_level children for rp
-        boost::json::array children {};
-        rp_children_get(conn_ptr,rp_.at("id").as_string().c_str(),children);
-        rp_.emplace("children",children);
-        PQfinish(conn_ptr);
+        rp_+=",\"children\":";
+        rp_children_get(conn_ptr,rp_uid_,rp_);
+        rp_+='}';
+        conn.release();
 
-        msg=boost::json::serialize(rp_);
+        msg=std::move(rp_);
         return db_status::success;
     }
     return db_status::fail;
@@ -1998,7 +1774,8 @@ db_status dbase_handler::rp_child_put(const std::string &parent_uid, const std::
 //Remove Child From Role
 db_status dbase_handler::rp_child_delete(const std::string &parent_uid, const std::string &child_uid, const std::string &requester_id, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -2008,84 +1785,280 @@ db_status dbase_handler::rp_child_delete(const std::string &parent_uid, const st
         const std::string& rp_ident {"role_permission:update"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
     {//check if rp exists
         if(!is_rp_exists(conn_ptr,parent_uid,msg) || !is_rp_exists(conn_ptr,child_uid,msg)){
-            PQfinish(conn_ptr);
             return db_status::not_found;
         }
     }
     {//delete relationship
-        const std::string& query {"DELETE FROM roles_permissions_relationship WHERE parent_id=$1 AND child_id=$2"};
         const char* param_values[] {parent_uid.c_str(),child_uid.c_str()};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),2,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"rp_child_delete",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_COMMAND_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
         PQclear(res_ptr);
+        authz_changed();
     }
     {//send rp with all children back
-        const std::string& query {"SELECT * FROM roles_permissions WHERE id=$1"};
         const char* param_values[] {parent_uid.c_str()};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"rp_get",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
 
         const int& rows {PQntuples(res_ptr)};
         if(!rows){
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::not_found;
         }
-        const int& columns {PQnfields(res_ptr)};
-        boost::json::object rp_ {};
-
-        for(int c=0;c < columns;++c){
-            const char* key {PQfname(res_ptr,c)};
-            const char* value {PQgetvalue(res_ptr,0,c)};
-            const int& is_null {PQgetisnull(res_ptr,0,c)};
-            rp_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-        }
+        std::string rp_ {};
+        dbase_json_encoder {res_ptr}.row_open(res_ptr,0,rp_);
+        const std::string& rp_uid_ {PQgetvalue(res_ptr,0,PQfnumber(res_ptr,"id"))};
         PQclear(res_ptr);
 
         //get all first_level children for rp
-        boost::json::array children {};
-        rp_children_get(conn_ptr,rp_.at("id").as_string().c_str(),children);
-        rp_.emplace("children",children);
-        PQfinish(conn_ptr);
+        rp_+=",\"children\":";
+        rp_children_get(conn_ptr,rp_uid_,rp_);
+        rp_+='}';
+        conn.release();
 
-        msg=boost::json::serialize(rp_);
+        msg=std::move(rp_);
         return db_status::success;
     }
     return db_status::fail;
 }
 
+//Effective set as json, version is fnv-1a over ids, names and admin flag
+void dbase_handler::effective_write(const std::string &user_uid, std::vector<std::pair<std::string, std::string>> &rps, bool admin,
+                                    std::string &effective, std::string &version)
+{
+    std::sort(rps.begin(),rps.end(),[](const std::pair<std::string,std::string>& a,const std::pair<std::string,std::string>& b){
+        return a.second<b.second;
+    });
+
+    std::uint64_t hash {14695981039346656037ULL};
+    const auto& hash_add {[&hash](const std::string& value){
+        for(const char& c:value){
+            hash^=static_cast<unsigned char>(c);
+            hash*=1099511628211ULL;
+        }
+        hash^=0xff;
+        hash*=1099511628211ULL;
+    }};
+    hash_add(admin ? "1" : "0");
+    for(const auto& rp:rps){
+        hash_add(rp.first);
+        hash_add(rp.second);
+    }
+    version=(boost::format("%016x") % hash).str();
+
+    effective+="{\"user_id\":";
+    dbase_json_encoder::string_write(user_uid.c_str(),user_uid.size(),effective);
+    effective+=",\"version\":\"" + version + "\",\"admin\":";
+    effective+=admin ? "true" : "false";
+    effective+=",\"count\":" + std::to_string(rps.size()) + ",\"items\":[";
+    for(std::size_t i=0;i<rps.size();++i){
+        effective+=i ? ",{\"id\":" : "{\"id\":";
+        dbase_json_encoder::string_write(rps[i].first.c_str(),rps[i].first.size(),effective);
+        effective+=",\"name\":";
+        dbase_json_encoder::string_write(rps[i].second.c_str(),rps[i].second.size(),effective);
+        effective+='}';
+    }
+    effective+="]}";
+}
+
+//Get User Effective Roles And Permissions
+db_status dbase_handler::user_effective_get(const std::string &user_uid, std::string &effective, std::string &version, const std::string &requester_id, std::string &msg)
+{
+    const std::string& rp_ident {"role_permission:read"};
+    std::vector<std::pair<std::string,std::string>> rps {};
+    bool admin {false};
+    {//answer from memory without taking a connection
+        if(context_.authz_engine_ptr){
+            const authz_result& result {context_.authz_engine_ptr->is_authorized(requester_id,{rp_ident})};
+            if(result==authz_result::deny){
+                return db_status::unauthorized;
+            }
+            //snapshot indexes granted users only, every one of them has at least one rp;
+            //an empty set may be an unknown uid and is left to SQL
+            if(result==authz_result::allow && context_.authz_engine_ptr->effective_get(user_uid,rps,admin) && !rps.empty()){
+                effective_write(user_uid,rps,admin,effective,version);
+                return db_status::success;
+            }
+        }
+    }
+
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
+    PGresult* res_ptr {NULL};
+    if(!conn_ptr){
+        return db_status::fail;
+    }
+    {//check if authorized
+        std::string msg {};
+        const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
+        if(!authorized){
+            return db_status::unauthorized;
+        }
+    }
+    if(!is_user_exists(conn_ptr,user_uid,msg)){
+        return db_status::not_found;
+    }
+    const char* param_values[] {user_uid.c_str()};
+    res_ptr=statement_exec(conn_ptr,"user_effective_get",param_values);
+    if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
+        msg=std::string {PQresultErrorMessage(res_ptr)};
+        PQclear(res_ptr);
+        return db_status::fail;
+    }
+    const int& rows {PQntuples(res_ptr)};
+    rps.reserve(rows);
+    for(int r=0;r<rows;++r){
+        rps.emplace_back(PQgetvalue(res_ptr,r,0),PQgetvalue(res_ptr,r,1));
+        admin=admin || PQgetvalue(res_ptr,r,2)[0]=='t';
+    }
+    PQclear(res_ptr);
+    conn.release();
+
+    effective_write(user_uid,rps,admin,effective,version);
+    return db_status::success;
+}
+
 //Check That User Authorized To Role Or Permission
 db_status dbase_handler::authz_check_get(const std::string &user_uid, const std::string &rp_ident, bool &authorized, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    const std::vector<std::string>& rp_idents {rp_idents_split(rp_ident)};
+    if(rp_idents.empty()){
+        authorized=false;
+        return db_status::success;
+    }
+    std::string key {};
+    std::uint64_t generation {0};
+    {//answer from memory without taking a connection
+        const authz_result& result {authz_memory_get(user_uid,rp_idents,key,generation)};
+        if(result!=authz_result::unknown){
+            authorized=(result==authz_result::allow);
+            return db_status::success;
+        }
+    }
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     if(!conn_ptr){
         return db_status::fail;
     }
-    authorized=is_authorized(conn_ptr,user_uid,rp_ident,msg);
-    PQfinish(conn_ptr);
+    authorized=authz_sql_get(conn_ptr,user_uid,rp_idents,key,generation,msg);
+    return db_status::success;
+}
+
+//Check Batch Of User And Role Or Permission Pairs
+db_status dbase_handler::authz_batch_check(const std::string &checks, std::string &decisions, std::string &msg)
+{
+    //user_uid and split rp_ident per entry
+    std::vector<std::pair<std::string,std::vector<std::string>>> entries {};
+    {//parse [{"user_id":"...","rp_ident":"..."},...]
+        boost::system::error_code ec;
+        const boost::json::value& checks_ {boost::json::parse(checks,ec)};
+        if(ec || !checks_.is_array()){
+            msg="checks not valid, array of {\"user_id\",\"rp_ident\"} expected";
+            return db_status::fail;
+        }
+        const boost::json::array& checks_array {checks_.as_array()};
+        if(checks_array.empty() || checks_array.size()>static_cast<std::size_t>(context_.authz_batch_max)){
+            msg="checks not valid, 1 to " + std::to_string(context_.authz_batch_max) + " entries expected";
+            return db_status::fail;
+        }
+        entries.reserve(checks_array.size());
+        for(std::size_t i=0;i<checks_array.size();++i){
+            const boost::json::object* check_ptr {checks_array[i].if_object()};
+            const boost::json::value* user_ptr {check_ptr ? check_ptr->if_contains("user_id") : nullptr};
+            const boost::json::value* ident_ptr {check_ptr ? check_ptr->if_contains("rp_ident") : nullptr};
+            if(!user_ptr || !user_ptr->is_string() || !ident_ptr || !ident_ptr->is_string()){
+                msg="checks not valid, entry " + std::to_string(i) + " needs string 'user_id' and 'rp_ident'";
+                return db_status::fail;
+            }
+            entries.emplace_back(std::string {user_ptr->as_string().c_str()},rp_idents_split(ident_ptr->as_string().c_str()));
+        }
+    }
+
+    std::vector<bool> allowed(entries.size(),false);
+    std::vector<std::size_t> pending {};
+    //cache key and generation per entry, for decisions taken by SQL
+    std::vector<std::pair<std::string,std::uint64_t>> keys(entries.size());
+    {//answer from memory, entries without idents or with malformed user_id are denied
+        for(std::size_t i=0;i<entries.size();++i){
+            if(entries[i].second.empty() || !http_router::is_uid(entries[i].first)){
+                continue;
+            }
+            const authz_result& result {authz_memory_get(entries[i].first,entries[i].second,keys[i].first,keys[i].second)};
+            if(result!=authz_result::unknown){
+                allowed[i]=(result==authz_result::allow);
+                continue;
+            }
+            pending.push_back(i);
+        }
+    }
+    if(!pending.empty()){//rest in one round trip on one connection
+        std::vector<std::string> indices {};
+        std::vector<std::string> user_uids {};
+        std::vector<std::string> idents {};
+        for(const std::size_t& i:pending){
+            for(const std::string& rp_ident:entries[i].second){
+                indices.push_back(std::to_string(i));
+                user_uids.push_back(entries[i].first);
+                idents.push_back(rp_ident);
+            }
+        }
+        dbase_connection conn {context_.dbase_pool_ptr,msg};
+        PGconn* conn_ptr {conn.get()};
+        if(!conn_ptr){
+            return db_status::fail;
+        }
+        const std::string& indices_ {text_array_literal(indices)};
+        const std::string& user_uids_ {text_array_literal(user_uids)};
+        const std::string& idents_ {text_array_literal(idents)};
+        const char* param_values[] {indices_.c_str(),user_uids_.c_str(),idents_.c_str()};
+        PGresult* res_ptr {statement_exec(conn_ptr,"authz_batch_check",param_values)};
+        if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            return db_status::fail;
+        }
+        const int& rows {PQntuples(res_ptr)};
+        for(int r=0;r<rows;++r){
+            const std::size_t& i {static_cast<std::size_t>(std::stoul(PQgetvalue(res_ptr,r,0)))};
+            if(i<allowed.size()){
+                allowed[i]=(PQgetvalue(res_ptr,r,1)[0]=='t');
+                authz_memory_put(keys[i].first,keys[i].second,allowed[i]);
+            }
+        }
+        PQclear(res_ptr);
+        conn.release();
+    }
+
+    decisions.reserve(allowed.size()*6+2);
+    decisions+='[';
+    for(std::size_t i=0;i<allowed.size();++i){
+        if(i){
+            decisions+=',';
+        }
+        decisions+=allowed[i] ? "true" : "false";
+    }
+    decisions+=']';
     return db_status::success;
 }
 
 //Assign Role Or Permission To User
 db_status dbase_handler::authz_manage_post(const std::string &requested_user_uid, const std::string &requested_rp_uid, const std::string &requester_id, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -2095,59 +2068,46 @@ db_status dbase_handler::authz_manage_post(const std::string &requested_user_uid
         const std::string& rp_ident {"authorization_manage:update"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
     {//check if user exists
         if(!is_user_exists(conn_ptr,requested_user_uid,msg) || !is_rp_exists(conn_ptr,requested_rp_uid,msg)){
-            PQfinish(conn_ptr);
             return db_status::not_found;
         }
     }
     {//assign
         const std::string& created_at {time_with_timezone()};
-        const std::string& query {"INSERT INTO users_roles_permissions (created_at,user_id,role_permission_id) VALUES($1,$2,$3)"};
         const char* param_values[] {created_at.c_str(),requested_user_uid.c_str(),requested_rp_uid.c_str()};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),3,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"urp_insert",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_COMMAND_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
         PQclear(res_ptr);
+        authz_changed();
     }
     {//send assigned role and permission back
-        const std::string& query {"SELECT * FROM roles_permissions WHERE id=$1"};
         const char* param_values[] {requested_rp_uid.c_str()};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"rp_get",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
 
         const int& rows {PQntuples(res_ptr)};
         if(!rows){
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::not_found;
         }
-        const int& columns {PQnfields(res_ptr)};
-        boost::json::object rp_ {};
-
-        for(int c=0;c < columns;++c){
-            const char* key {PQfname(res_ptr,c)};
-            const char* value {PQgetvalue(res_ptr,0,c)};
-            const int& is_null {PQgetisnull(res_ptr,0,c)};
-            rp_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-        }
+        std::string rp_ {};
+        dbase_json_encoder {res_ptr}.row_write(res_ptr,0,rp_);
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
+        conn.release();
 
-        msg=boost::json::serialize(rp_);
+        msg=std::move(rp_);
         return db_status::success;
     }
     return db_status::fail;
@@ -2156,7 +2116,8 @@ db_status dbase_handler::authz_manage_post(const std::string &requested_user_uid
 //Revoke Role Or Permission From User
 db_status dbase_handler::authz_manage_delete(const std::string &requested_user_uid, const std::string &requested_rp_uid, const std::string &requester_id, std::string &msg)
 {
-    PGconn* conn_ptr {open_connection(msg)};
+    dbase_connection conn {context_.dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
     PGresult* res_ptr {NULL};
     if(!conn_ptr){
         return db_status::fail;
@@ -2166,58 +2127,45 @@ db_status dbase_handler::authz_manage_delete(const std::string &requested_user_u
         const std::string& rp_ident {"authorization_manage:update"};
         const bool& authorized {is_authorized(conn_ptr,requester_id,rp_ident,msg)};
         if(!authorized){
-            PQfinish(conn_ptr);
             return db_status::unauthorized;
         }
     }
     {//check if user exists
         if(!is_user_exists(conn_ptr,requested_user_uid,msg) || !is_rp_exists(conn_ptr,requested_rp_uid,msg)){
-            PQfinish(conn_ptr);
             return db_status::not_found;
         }
     }
     {//remove
-        const std::string& query {"DELETE FROM users_roles_permissions WHERE user_id=$1 AND role_permission_id=$2"};
         const char* param_values[] {requested_user_uid.c_str(),requested_rp_uid.c_str()};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),2,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"urp_delete",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_COMMAND_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
         PQclear(res_ptr);
+        authz_changed();
     }
     {//send assigned role and permission back
-        const std::string& query {"SELECT * FROM roles_permissions WHERE id=$1"};
         const char* param_values[] {requested_rp_uid.c_str()};
-        res_ptr=PQexecParams(conn_ptr,query.c_str(),1,NULL,param_values,NULL,NULL,0);
+        res_ptr=statement_exec(conn_ptr,"rp_get",param_values);
         if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
             msg=std::string {PQresultErrorMessage(res_ptr)};
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::fail;
         }
 
         const int& rows {PQntuples(res_ptr)};
         if(!rows){
             PQclear(res_ptr);
-            PQfinish(conn_ptr);
             return db_status::not_found;
         }
-        const int& columns {PQnfields(res_ptr)};
-        boost::json::object rp_ {};
-
-        for(int c=0;c < columns;++c){
-            const char* key {PQfname(res_ptr,c)};
-            const char* value {PQgetvalue(res_ptr,0,c)};
-            const int& is_null {PQgetisnull(res_ptr,0,c)};
-            rp_.emplace(key,is_null ? boost::json::value(nullptr) : value);
-        }
+        std::string rp_ {};
+        dbase_json_encoder {res_ptr}.row_write(res_ptr,0,rp_);
         PQclear(res_ptr);
-        PQfinish(conn_ptr);
+        conn.release();
 
-        msg=boost::json::serialize(rp_);
+        msg=std::move(rp_);
         return db_status::success;
     }
     return db_status::fail;
@@ -2,8 +2,11 @@
 #define DBASE_HANDLER_H
 
 #include <map>
+#include <vector>
 #include <string>
 #include <memory>
+#include <utility>
+#include <cstdint>
 #include <boost/json.hpp>
 #include <boost/asio.hpp>
 
@@ -14,18 +17,20 @@
 namespace spdlog{
     class logger;
 }
+struct server_context;
+class chunk_stream;
+enum class authz_result;
 
 class dbase_handler
 {
 private:
-    boost::asio::io_context io_;
-    boost::json::object params_ {};
-    std::shared_ptr<spdlog::logger> logger_ptr_ {nullptr};
+    //owned by session, outlives handler
+    const server_context& context_;
     static bool is_initiated_ ;
 
     std::string time_with_timezone();
-    //Open connection
-    PGconn* open_connection(std::string& msg);
+    //Run named statement from dbase_statements as prepared statement
+    PGresult* statement_exec(PGconn* conn_ptr,const std::string& name,const char* const* param_values);
     //Init tables if empty or not exists
     bool init_tables(PGconn* conn_ptr, std::string &msg);
     //Init default roles-permissions
@@ -37,8 +42,41 @@ private:
     bool is_rp_exists(PGconn* conn_ptr,const std::string& rp_uid,std::string& msg);
     //Check if user exists by user_uid
     bool is_user_exists(PGconn* conn_ptr,const std::string& user_uid,std::string& msg);
-    //Check if user authorized
+    //Split rp_ident into rp_uids or names
+    static std::vector<std::string> rp_idents_split(const std::string& rp_ident);
+    //Mark authz_engine snapshot and decision cache stale
+    void authz_changed();
+    //Decision from authz_engine or decision cache, unknown means SQL; key and generation are kept for authz_memory_put
+    authz_result authz_memory_get(const std::string& user_uid,const std::vector<std::string>& rp_idents,std::string& key,std::uint64_t& generation);
+    //Cache decision taken by SQL, no-op without cache
+    void authz_memory_put(const std::string& key,std::uint64_t generation,bool allowed);
+    //Decide by authz_check statement and cache the result
+    bool authz_sql_get(PGconn* conn_ptr,const std::string& user_uid,const std::vector<std::string>& rp_idents,
+                       const std::string& key,std::uint64_t generation,std::string& msg);
+    //Build postgres text[] literal
+    static std::string text_array_literal(const std::vector<std::string>& items);
+    //Check if user authorized, one round trip
     bool is_authorized(PGconn* conn_ptr, const std::string& user_uid, const std::string& rp_ident,std::string& msg);
+    //Parse non-negative int from query value
+    static bool number_parse(const std::string& text,int& value);
+    //Take limit, offset and keyset cursor out of query_map, cursor replaces offset
+    static bool paging_parse(std::map<std::string,std::string>& query_map,std::size_t keys_count,int& limit,int& offset,
+                             std::vector<std::string>& cursor_keys,std::string& msg);
+    //Effective set as json and its content version, rps are sorted by name first
+    static void effective_write(const std::string& user_uid,std::vector<std::pair<std::string,std::string>>& rps,bool admin,
+                                std::string& effective,std::string& version);
+    //Append value to bound parameters, returns "$n"
+    static std::string param_bind(std::vector<std::string>& values,const std::string& value);
+    //Append page members up to "items":, caller writes the items array and closes the object
+    static void page_open(int limit,int offset,int count,int total,const boost::json::value* next_cursor_ptr,std::string& out);
+    //Send query in single-row mode and write rows to stream as they arrive,
+    //head opens the items array, next_cursor is built from cursor_columns of the last row of a full page
+    db_status rows_stream(PGconn* conn_ptr,const char* query,const std::vector<const char*>& param_values,chunk_stream* stream_ptr,
+                          const std::string& head,int limit,const std::vector<std::string>& cursor_columns,std::string& msg);
+    //Get count(*) from named statement
+    int count_get(PGconn* conn_ptr,const std::string& name,const char* const* param_values);
+    //Get unfiltered table total
+    int table_total_get(PGconn* conn_ptr,const std::string& table,const std::string& name);
     //Get total urp
     int urp_total_get(PGconn* conn_ptr);
     //Get total rps
@@ -47,31 +85,32 @@ private:
     int user_total_get(PGconn* conn_ptr);
     //Get UAuthAmin rp_uid
     std::string uath_admin_rp_uid_get(PGconn* conn_ptr);
-    //Get all rp_uids recirsive
-    void rp_uid_recursive_get(PGconn* conn_ptr, std::vector<std::string> &rp_uids);
 
     bool rp_uids_child_get(PGconn* conn_ptr,const std::string& rp_uid,std::vector<std::string>& child_uids,std::string& msg);
     bool rp_uids_parent_get(PGconn* conn_ptr,const std::string& rp_uid,std::vector<std::string>& parent_uids,std::string& msg);
 
     //Get all child rp for parent rp by rp_uid
-    void rp_children_get(PGconn* conn_ptr,const std::string& rp_uid,boost::json::array& rp_objs);
+    void rp_children_get(PGconn* conn_ptr,const std::string& rp_uid,std::string& rp_objs);
     //Get rp_uids by rp_names
     void rp_uids_by_rp_names_get(PGconn* conn_ptr,const std::vector<std::string>& rp_names,std::vector<std::string>& rp_uids);
     //Get all user_uids from 'users_roles_permissions' by rp_uid
     bool user_uids_by_rp_uid_get(PGconn* conn_ptr,const std::string& rp_uid,std::vector<std::string>& user_uids,std::string& msg);
 
 public:
-    explicit dbase_handler(const boost::json::object& params,std::shared_ptr<spdlog::logger> logger_ptr);
+    explicit dbase_handler(const server_context& context);
     ~dbase_handler()=default;
 
     //Init database
     bool init_database(std::string& msg);
+    //Parse limit and offset of a page without cursor, same rules as paging_parse, absent values are left as they are
+    static bool paging_check(const std::map<std::string,std::string>& query_map,int& limit,int& offset,std::string& msg);
     //List Of Users with limit and/or offset and filter
-    db_status user_list_get(std::string& users, std::map<std::string, std::string> query_map, const std::string& requester_id, std::string& msg);
+    //stream_ptr not null: rows are written to it as chunks and users stays empty
+    db_status user_list_get(std::string& users, std::map<std::string, std::string> query_map, const std::string& requester_id, chunk_stream* stream_ptr, std::string& msg);
     //Get User Info
     db_status user_info_get(const std::string& user_uid, std::string &user,const std::string& requester_id,std::string& msg);
-    //Get User Assigned Roles And Permissions
-    db_status user_rp_get(const std::string& user_uid,const std::string& limit,const std::string& offset,std::string& rps,const std::string& requester_id,std::string& msg);
+    //Get User Assigned Roles And Permissions, limit 0 is no LIMIT
+    db_status user_rp_get(const std::string& user_uid,int limit,int offset,std::string& rps,const std::string& requester_id,std::string& msg);
 
     //Get User Assigned Roles And Permissions with limit and/or offset
     //db_status user_rp_get(const std::string& user_uid,std::string& rps,const std::string& limit,const std::string& offset,const std::string& requester_id,std::string& msg);
@@ -84,13 +123,13 @@ public:
     db_status user_info_delete(const std::string& user_uid,const std::string& requester_id,std::string& msg);
 
     //List Of Roles And Permissions with limit and/or offset and filter
-    db_status rp_list_get(std::string& rps, std::map<std::string, std::string> query_map, const std::string& requester_id, std::string& msg);
+    db_status rp_list_get(std::string& rps, std::map<std::string, std::string> query_map, const std::string& requester_id, chunk_stream* stream_ptr, std::string& msg);
     //Get Permission Or Role
     db_status rp_info_get(const std::string& rp_uid,std::string& rp,const std::string& requester_id,std::string& msg);
     //Get Associated Users
-    db_status rp_user_get(const std::string& rp_uid,std::string& users,const std::string& requester_id,std::string& msg);
-    //Get Associated Users with limit and/or offset
-    db_status rp_user_get(const std::string& rp_uid,std::string& users,const std::string& limit,const std::string& offset,const std::string& requester_id,std::string& msg);
+    db_status rp_user_get(const std::string& rp_uid,std::string& users,const std::string& requester_id,chunk_stream* stream_ptr,std::string& msg);
+    //Get Associated Users with limit and/or offset, limit 0 is no LIMIT
+    db_status rp_user_get(const std::string& rp_uid,std::string& users,int limit,int offset,const std::string& requester_id,chunk_stream* stream_ptr,std::string& msg);
     //Get Permission Or Role Detail
     db_status rp_rp_detail_get(const std::string& rp_uid,std::string& rp,const std::string& requester_id,std::string& msg);
     //Create Permission Or Role
@@ -104,8 +143,13 @@ public:
     //Remove Child From Role
     db_status rp_child_delete(const std::string& parent_uid,const std::string& child_uid,const std::string& requester_id,std::string& msg);
 
+    //Get User Effective Roles And Permissions, version changes with the set
+    db_status user_effective_get(const std::string& user_uid,std::string& effective,std::string& version,const std::string& requester_id,std::string& msg);
+
     //Check That User Authorized To Role Or Permission
     db_status authz_check_get(const std::string& user_uid, const std::string& rp_ident, bool& authorized, std::string& msg);
+    //Check Batch Of User And Role Or Permission Pairs, decisions as json array in request order
+    db_status authz_batch_check(const std::string& checks,std::string& decisions,std::string& msg);
     //Assign Role Or Permission To User
     db_status authz_manage_post(const std::string& requested_user_uid, const std::string& requested_rp_uid,const std::string& requester_id,std::string& msg);
     //Revoke Role Or Permission From User
@@ -0,0 +1,144 @@
+#include "dbase_json_encoder.h"
+
+#include <cstring>
+
+//type oids from catalog/pg_type.h, server headers are not needed by the client
+namespace{
+    const Oid bool_oid {16};
+    const Oid int8_oid {20};
+    const Oid int2_oid {21};
+    const Oid int4_oid {23};
+    const Oid date_oid {1082};
+    const Oid timestamp_oid {1114};
+    const Oid timestamptz_oid {1184};
+    const Oid uuid_oid {2950};
+}
+
+dbase_json_encoder::dbase_json_encoder(const PGresult *res_ptr)
+{
+    const int& columns {PQnfields(res_ptr)};
+    columns_.reserve(columns);
+    for(int c=0;c < columns;++c){
+        column column_ {};
+        if(c){
+            column_.key+=',';
+        }
+        const char* name {PQfname(res_ptr,c)};
+        string_write(name,std::strlen(name),column_.key);
+        column_.key+=':';
+
+        switch(PQftype(res_ptr,c)){
+        case bool_oid:
+            column_.kind=column_kind::boolean;
+            break;
+        case int8_oid:
+        case int2_oid:
+        case int4_oid:
+        case date_oid:
+        case timestamp_oid:
+        case timestamptz_oid:
+        case uuid_oid:
+            column_.kind=column_kind::plain;
+            break;
+        default:
+            column_.kind=column_kind::text;
+            break;
+        }
+        columns_.push_back(column_);
+    }
+}
+
+void dbase_json_encoder::row_open(const PGresult *res_ptr, int row, std::string &out) const
+{
+    out+='{';
+    for(std::size_t c=0;c < columns_.size();++c){
+        const column& column_ {columns_[c]};
+        out+=column_.key;
+        if(PQgetisnull(res_ptr,row,static_cast<int>(c))){
+            out+="null";
+            continue;
+        }
+        const char* value {PQgetvalue(res_ptr,row,static_cast<int>(c))};
+        switch(column_.kind){
+        case column_kind::boolean:
+            out+=value[0]=='t' ? "true" : "false";
+            break;
+        case column_kind::plain:
+            out+='"';
+            out.append(value,PQgetlength(res_ptr,row,static_cast<int>(c)));
+            out+='"';
+            break;
+        case column_kind::text:
+            string_write(value,PQgetlength(res_ptr,row,static_cast<int>(c)),out);
+            break;
+        }
+    }
+}
+
+void dbase_json_encoder::row_write(const PGresult *res_ptr, int row, std::string &out) const
+{
+    row_open(res_ptr,row,out);
+    out+='}';
+}
+
+void dbase_json_encoder::rows_write(const PGresult *res_ptr, std::string &out) const
+{
+    const int& rows {PQntuples(res_ptr)};
+    out+='[';
+    for(int r=0;r < rows;++r){
+        if(r){
+            out+=',';
+        }
+        const std::size_t& size {out.size()};
+        row_write(res_ptr,r,out);
+        if(!r){//rows of one result are about the same size
+            out.reserve(out.size()+(out.size()-size+1)*(rows-1)+1);
+        }
+    }
+    out+=']';
+}
+
+void dbase_json_encoder::string_write(const char *value, std::size_t length, std::string &out)
+{
+    static const char hex[] {"0123456789abcdef"};
+    out+='"';
+    std::size_t begin {0};
+    for(std::size_t i=0;i < length;++i){
+        const unsigned char& c {static_cast<unsigned char>(value[i])};
+        if(c>=0x20 && c!='"' && c!='\\'){
+            continue;
+        }
+        out.append(value+begin,i-begin);
+        begin=i+1;
+        switch(c){
+        case '"':
+            out+="\\\"";
+            break;
+        case '\\':
+            out+="\\\\";
+            break;
+        case '\b':
+            out+="\\b";
+            break;
+        case '\f':
+            out+="\\f";
+            break;
+        case '\n':
+            out+="\\n";
+            break;
+        case '\r':
+            out+="\\r";
+            break;
+        case '\t':
+            out+="\\t";
+            break;
+        default:
+            out+="\\u00";
+            out+=hex[c>>4];
+            out+=hex[c&0x0f];
+            break;
+        }
+    }
+    out.append(value+begin,length-begin);
+    out+='"';
+}
@@ -0,0 +1,45 @@
+#ifndef DBASE_JSON_ENCODER_H
+#define DBASE_JSON_ENCODER_H
+
+#include <string>
+#include <vector>
+
+#include "libpq-fe.h"
+
+//Writes PGresult rows as json objects into an output buffer,
+//column keys, types and escaping are resolved once per result
+class dbase_json_encoder
+{
+private:
+    enum class column_kind{
+        //escaped string
+        text,
+        //quoted as is, uuid, timestamps and numbers never need escaping
+        plain,
+        //true/false
+        boolean
+    };
+    struct column{
+        //"\"name\":" with leading ',' for all but the first column
+        std::string key;
+        column_kind kind;
+    };
+    std::vector<column> columns_ {};
+
+public:
+    //Metadata only, result may be cleared afterwards; single-row results of one query share it
+    explicit dbase_json_encoder(const PGresult* res_ptr);
+    ~dbase_json_encoder()=default;
+
+    //Append '{' and row members, caller closes the object or appends more members
+    void row_open(const PGresult* res_ptr,int row,std::string& out) const;
+    //Append row as json object
+    void row_write(const PGresult* res_ptr,int row,std::string& out) const;
+    //Append all rows as json array
+    void rows_write(const PGresult* res_ptr,std::string& out) const;
+
+    //Append value as quoted json string
+    static void string_write(const char* value,std::size_t length,std::string& out);
+};
+
+#endif // DBASE_JSON_ENCODER_H
@@ -0,0 +1,233 @@
+#include "dbase_listener.h"
+#include "dbase_pool.h"
+#include "executor/task_executor.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <boost/date_time.hpp>
+#include "spdlog/spdlog.h"
+
+bool dbase_change::is_authz() const
+{
+    if(table.empty() || table=="roles_permissions" || table=="roles_permissions_relationship" || table=="users_roles_permissions"){
+        return true;
+    }
+    //a removed user takes its grants along
+    return table=="users" && (op=='D' || op=='T');
+}
+
+void dbase_listener::connect_schedule()
+{
+    const std::shared_ptr<dbase_listener>& self {shared_from_this()};
+    const bool& posted {dbase_executor_ptr_->task_post([self](){
+        std::string msg {};
+        PGconn* conn_ptr {self->dbase_pool_ptr_->connection_dedicated(msg)};
+        if(conn_ptr){
+            const std::string& command {"LISTEN " + self->channel_};
+            PGresult* res_ptr {PQexec(conn_ptr,command.c_str())};
+            if(PQresultStatus(res_ptr)!=PGRES_COMMAND_OK){
+                msg=std::string {PQresultErrorMessage(res_ptr)};
+                PQfinish(conn_ptr);
+                conn_ptr=NULL;
+            }
+            PQclear(res_ptr);
+        }
+        {//hand over, or drop when stopped meanwhile
+            std::lock_guard<std::mutex> lock {self->mutex_};
+            if(self->stopped_){
+                if(conn_ptr){
+                    PQfinish(conn_ptr);
+                }
+                return;
+            }
+            self->conn_ptr_=conn_ptr;
+        }
+        boost::asio::post(self->strand_,[self,msg](){
+            self->on_connected(msg);
+        });
+    })};
+    if(!posted){//executor queue full, try again later
+        connection_lost("dbase executor queue full");
+    }
+}
+
+void dbase_listener::on_connected(const std::string &msg)
+{
+    if(stopped_){
+        return;
+    }
+    if(!conn_ptr_){
+        connection_lost(msg);
+        return;
+    }
+    boost::system::error_code ec;
+    socket_.assign(boost::asio::ip::tcp::v4(),PQsocket(conn_ptr_),ec);
+    if(ec){
+        connection_lost(ec.message());
+        return;
+    }
+    connects_.fetch_add(1,std::memory_order_relaxed);
+    if(logger_ptr_){
+        logger_ptr_->info("{}, listening on channel '{}'",
+            BOOST_CURRENT_FUNCTION,channel_);
+    }
+    //changes made while not listening are unknown
+    change_dispatch(dbase_change {});
+    do_wait();
+}
+
+void dbase_listener::do_wait()
+{
+    const std::shared_ptr<dbase_listener>& self {shared_from_this()};
+    socket_.async_wait(boost::asio::ip::tcp::socket::wait_read,
+                       boost::asio::bind_executor(strand_,[self](const boost::system::error_code& ec){
+        self->on_wait(ec);
+    }));
+}
+
+void dbase_listener::on_wait(const boost::system::error_code &ec)
+{
+    if(ec==boost::asio::error::operation_aborted || stopped_){
+        return;
+    }
+    if(ec){
+        connection_lost(ec.message());
+        return;
+    }
+    if(!PQconsumeInput(conn_ptr_)){
+        connection_lost(std::string {PQerrorMessage(conn_ptr_)});
+        return;
+    }
+    PGnotify* notify_ptr {NULL};
+    while((notify_ptr=PQnotifies(conn_ptr_))!=NULL){
+        notifications_.fetch_add(1,std::memory_order_relaxed);
+        dbase_change change {};
+        if(change_parse(notify_ptr->extra,change)){
+            change_dispatch(change);
+        }
+        PQfreemem(notify_ptr);
+    }
+    do_wait();
+}
+
+void dbase_listener::connection_lost(const std::string &msg)
+{
+    if(stopped_){
+        return;
+    }
+    connection_close();
+    disconnects_.fetch_add(1,std::memory_order_relaxed);
+    if(logger_ptr_){
+        logger_ptr_->error("{}, listen connection lost, retry in {}s, notifications: {}, error: {}",
+            BOOST_CURRENT_FUNCTION,reconnect_interval_,notifications_.load(std::memory_order_relaxed),msg);
+    }
+    const std::shared_ptr<dbase_listener>& self {shared_from_this()};
+    timer_.expires_from_now(boost::posix_time::seconds(reconnect_interval_));
+    timer_.async_wait(boost::asio::bind_executor(strand_,[self](const boost::system::error_code& ec){
+        self->on_timer(ec);
+    }));
+}
+
+void dbase_listener::connection_close()
+{
+    boost::system::error_code ec;
+    if(socket_.is_open()){
+        socket_.cancel(ec);
+        socket_.release(ec);
+    }
+    std::lock_guard<std::mutex> lock {mutex_};
+    if(conn_ptr_){
+        PQfinish(conn_ptr_);
+        conn_ptr_=NULL;
+    }
+}
+
+void dbase_listener::on_timer(const boost::system::error_code &ec)
+{
+    if(ec==boost::asio::error::operation_aborted || stopped_){
+        return;
+    }
+    connect_schedule();
+}
+
+void dbase_listener::change_dispatch(const dbase_change &change)
+{
+    for(const std::function<void(const dbase_change&)>& invalidator:invalidators_){
+        invalidator(change);
+    }
+}
+
+bool dbase_listener::change_parse(const char *payload, dbase_change &change)
+{
+    //"table:op:id", id may be empty for truncate
+    const char* op_ptr {std::strchr(payload,':')};
+    if(!op_ptr || op_ptr==payload || op_ptr[1]=='\0' || op_ptr[2]!=':'){
+        return false;
+    }
+    change.table.assign(payload,op_ptr);
+    change.op=op_ptr[1];
+    change.id.assign(op_ptr+3);
+    return true;
+}
+
+dbase_listener::dbase_listener(boost::asio::io_context &io, int reconnect_interval, std::shared_ptr<dbase_pool> dbase_pool_ptr,
+                               std::shared_ptr<task_executor> dbase_executor_ptr, std::shared_ptr<spdlog::logger> logger_ptr)
+    :reconnect_interval_{std::max(1,reconnect_interval)},strand_{boost::asio::make_strand(io)},timer_{io},socket_{io},
+     dbase_pool_ptr_{dbase_pool_ptr},dbase_executor_ptr_{dbase_executor_ptr},logger_ptr_{logger_ptr}
+{
+}
+
+dbase_listener::~dbase_listener()
+{
+    connection_close();
+}
+
+int dbase_listener::triggers_count(std::shared_ptr<dbase_pool> dbase_pool_ptr, std::string &msg)
+{
+    dbase_connection conn {dbase_pool_ptr,msg};
+    PGconn* conn_ptr {conn.get()};
+    if(!conn_ptr){
+        return -1;
+    }
+    PGresult* res_ptr {PQexec(conn_ptr,"SELECT count(*) FROM pg_trigger t JOIN pg_proc p ON p.oid=t.tgfoid "
+                                       "WHERE p.proname='uauth_change_notify' AND NOT t.tgisinternal")};
+    if(PQresultStatus(res_ptr)!=PGRES_TUPLES_OK){
+        msg=std::string {PQresultErrorMessage(res_ptr)};
+        PQclear(res_ptr);
+        return -1;
+    }
+    const int& count {std::atoi(PQgetvalue(res_ptr,0,0))};
+    PQclear(res_ptr);
+    return count;
+}
+
+void dbase_listener::invalidator_add(std::function<void(const dbase_change &)> invalidator)
+{
+    invalidators_.push_back(invalidator);
+}
+
+void dbase_listener::listener_start()
+{
+    connect_schedule();
+    if(logger_ptr_){
+        logger_ptr_->info("{}, dbase_listener started",
+            BOOST_CURRENT_FUNCTION);
+    }
+}
+
+void dbase_listener::listener_stop()
+{
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        stopped_=true;
+    }
+    boost::system::error_code ec;
+    timer_.cancel(ec);
+    connection_close();
+    if(logger_ptr_){
+        logger_ptr_->info("{}, dbase_listener stopped, connects: {}, disconnects: {}, notifications: {}",
+            BOOST_CURRENT_FUNCTION,connects_.load(std::memory_order_relaxed),disconnects_.load(std::memory_order_relaxed),
+            notifications_.load(std::memory_order_relaxed));
+    }
+}
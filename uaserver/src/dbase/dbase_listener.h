@@ -0,0 +1,84 @@
+#ifndef DBASE_LISTENER_H
+#define DBASE_LISTENER_H
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <boost/asio.hpp>
+
+#include "libpq-fe.h"
+
+namespace spdlog{
+    class logger;
+}
+class dbase_pool;
+class task_executor;
+
+//Change record sent by the uauth_change_notify trigger as "table:op:id",
+//empty table means changes may have been missed and all state is suspect
+struct dbase_change
+{
+    std::string table {};
+    //'I','U','D', or 'T' for truncate
+    char op {'\0'};
+    std::string id {};
+
+    //Touches data behind authz decisions, resync included
+    bool is_authz() const;
+};
+
+//Dedicated LISTEN connection outside the pool, its libpq socket is watched by asio
+//and notifications are fanned out to invalidators on the listener strand
+class dbase_listener:public std::enable_shared_from_this<dbase_listener>
+{
+private:
+    const std::string channel_ {"uauth_changes"};
+    int reconnect_interval_ {5};
+    boost::asio::strand<boost::asio::io_context::executor_type> strand_;
+    boost::asio::deadline_timer timer_;
+    //wraps the libpq descriptor for readiness only, released before PQfinish
+    boost::asio::ip::tcp::socket socket_;
+    std::mutex mutex_;
+    PGconn* conn_ptr_ {NULL};
+    std::atomic<bool> stopped_ {false};
+    std::vector<std::function<void(const dbase_change&)>> invalidators_ {};
+
+    std::atomic<std::uint64_t> notifications_ {0};
+    std::atomic<std::uint64_t> connects_ {0};
+    std::atomic<std::uint64_t> disconnects_ {0};
+
+    std::shared_ptr<dbase_pool> dbase_pool_ptr_ {nullptr};
+    std::shared_ptr<task_executor> dbase_executor_ptr_ {nullptr};
+    std::shared_ptr<spdlog::logger> logger_ptr_ {nullptr};
+
+    //Connect and LISTEN on dbase executor, blocking libpq calls stay off io threads
+    void connect_schedule();
+    void on_connected(const std::string& msg);
+    void do_wait();
+    void on_wait(const boost::system::error_code& ec);
+    //Close connection and retry after reconnect_interval
+    void connection_lost(const std::string& msg);
+    void connection_close();
+    void on_timer(const boost::system::error_code& ec);
+    void change_dispatch(const dbase_change& change);
+    static bool change_parse(const char* payload,dbase_change& change);
+
+public:
+    explicit dbase_listener(boost::asio::io_context& io,int reconnect_interval,std::shared_ptr<dbase_pool> dbase_pool_ptr,
+                            std::shared_ptr<task_executor> dbase_executor_ptr,std::shared_ptr<spdlog::logger> logger_ptr);
+    ~dbase_listener();
+
+    //uauth_change_notify triggers installed by uatables, -1 and msg set when it can not be told
+    static int triggers_count(std::shared_ptr<dbase_pool> dbase_pool_ptr,std::string& msg);
+    //Register before listener_start
+    void invalidator_add(std::function<void(const dbase_change&)> invalidator);
+    void listener_start();
+    //Called after io_context stopped
+    void listener_stop();
+};
+
+#endif // DBASE_LISTENER_H
@@ -0,0 +1,367 @@
+#include "dbase_pool.h"
+#include "dbase_statements.h"
+
+#include <algorithm>
+#include <boost/format.hpp>
+#include "spdlog/spdlog.h"
+
+//Open PGConnection
+PGconn *dbase_pool::connection_open(std::string &msg)
+{
+    PGconn* conn_ptr {NULL};
+    const std::string& UA_DB_NAME {params_.at("UA_DB_NAME").as_string().c_str()};
+    const std::string& UA_DB_HOST {params_.at("UA_DB_HOST").as_string().c_str()};
+    const std::string& UA_DB_PORT {params_.at("UA_DB_PORT").as_string().c_str()};
+    const std::string& UA_DB_USER {params_.at("UA_DB_USER").as_string().c_str()};
+    const std::string& UA_DB_PASS {params_.at("UA_DB_PASS").as_string().c_str()};
+
+    boost::system::error_code ec;
+    boost::asio::ip::tcp::resolver r {io_};
+    const auto& ep_list {r.resolve(UA_DB_HOST,UA_DB_PORT,ec)};
+    if(ec){
+        msg=ec.message();
+        connect_errors_.fetch_add(1,std::memory_order_relaxed);
+        if(logger_ptr_){
+            logger_ptr_->error("{}, resolve failed: {}",
+                BOOST_CURRENT_FUNCTION,msg);
+        }
+        return nullptr;
+    }
+    boost::asio::ip::tcp::endpoint ep {*ep_list.begin()};
+    std::string conninfo {(boost::format("postgresql://%s:%s@%s:%d/%s?connect_timeout=10")
+        % UA_DB_USER
+        % UA_DB_PASS
+        % ep.address().to_string()
+        % ep.port()
+        % UA_DB_NAME).str()};
+
+    conn_ptr=PQconnectdb(conninfo.c_str());
+    if(PQstatus(conn_ptr)!=CONNECTION_OK){
+        msg=std::string {PQerrorMessage(conn_ptr)};
+        PQfinish(conn_ptr);
+        connect_errors_.fetch_add(1,std::memory_order_relaxed);
+        if(logger_ptr_){
+            logger_ptr_->error("{}, connect failed: {}",
+                BOOST_CURRENT_FUNCTION,msg);
+        }
+        return nullptr;
+    }
+    return conn_ptr;
+}
+
+bool dbase_pool::connection_check(PGconn *conn_ptr, bool ping, bool &reset)
+{
+    if(PQstatus(conn_ptr)==CONNECTION_OK){
+        if(!ping){
+            return true;
+        }
+        //empty query is the cheapest round trip to the backend
+        PGresult* res_ptr {PQexec(conn_ptr,"")};
+        const ExecStatusType& status {PQresultStatus(res_ptr)};
+        PQclear(res_ptr);
+        if(status==PGRES_EMPTY_QUERY){
+            return true;
+        }
+    }
+
+    PQreset(conn_ptr);
+    reset=true;
+    resets_.fetch_add(1,std::memory_order_relaxed);
+    if(PQstatus(conn_ptr)!=CONNECTION_OK){
+        connect_errors_.fetch_add(1,std::memory_order_relaxed);
+        if(logger_ptr_){
+            logger_ptr_->error("{}, reconnect failed: {}",
+                BOOST_CURRENT_FUNCTION,PQerrorMessage(conn_ptr));
+        }
+        return false;
+    }
+    return true;
+}
+
+void dbase_pool::connection_discard(std::unique_lock<std::mutex> &lock, PGconn *conn_ptr)
+{
+    connections_.erase(conn_ptr);
+    lock.unlock();
+    PQfinish(conn_ptr);
+    lock.lock();
+    //free slot, a waiter may open a new connection
+    cv_.notify_one();
+}
+
+bool dbase_pool::is_expired(const connection_info &info, std::chrono::steady_clock::time_point now) const
+{
+    return now-info.created_at>=max_lifetime_;
+}
+
+dbase_pool::dbase_pool(const boost::json::object &params, std::size_t pool_min, std::size_t pool_max,
+                       int max_lifetime, int acquire_timeout, std::shared_ptr<spdlog::logger> logger_ptr)
+    :io_{},params_{params},pool_min_{pool_min},pool_max_{std::max<std::size_t>(1,std::max(pool_min,pool_max))},
+     max_lifetime_{std::max(1,max_lifetime)},acquire_timeout_{std::max(1,acquire_timeout)},logger_ptr_{logger_ptr}
+{
+}
+
+dbase_pool::~dbase_pool()
+{
+    pool_stop();
+    //connections still checked out at shutdown
+    for(const auto& it:connections_){
+        PQfinish(it.first);
+    }
+    connections_.clear();
+}
+
+void dbase_pool::pool_warmup()
+{
+    std::unique_lock<std::mutex> lock {mutex_};
+    while(!stopped_ && connections_.size()+opening_<pool_min_){
+        ++opening_;
+        lock.unlock();
+        std::string msg {};
+        PGconn* conn_ptr {connection_open(msg)};
+        lock.lock();
+        --opening_;
+        if(!conn_ptr){
+            if(logger_ptr_){
+                logger_ptr_->warn("{}, warmup stopped at {} connections",
+                    BOOST_CURRENT_FUNCTION,connections_.size());
+            }
+            break;
+        }
+        const std::chrono::steady_clock::time_point& now {std::chrono::steady_clock::now()};
+        connections_.emplace(conn_ptr,connection_info{now,now});
+        idle_.push_back(conn_ptr);
+        cv_.notify_one();
+    }
+}
+
+void dbase_pool::pool_stop()
+{
+    std::vector<PGconn*> idle {};
+    {//take idle connections, busy ones are closed on release
+        std::lock_guard<std::mutex> lock {mutex_};
+        stopped_=true;
+        idle.swap(idle_);
+        for(PGconn* conn_ptr:idle){
+            connections_.erase(conn_ptr);
+        }
+    }
+    cv_.notify_all();
+    for(PGconn* conn_ptr:idle){
+        PQfinish(conn_ptr);
+    }
+}
+
+PGconn *dbase_pool::connection_dedicated(std::string &msg)
+{
+    return connection_open(msg);
+}
+
+PGconn *dbase_pool::connection_acquire(std::string &msg)
+{
+    const std::chrono::steady_clock::time_point& deadline {std::chrono::steady_clock::now()+acquire_timeout_};
+    std::unique_lock<std::mutex> lock {mutex_};
+    while(true){
+        if(stopped_){
+            msg="dbase pool stopped";
+            return nullptr;
+        }
+        {//take idle connection, most recently used first
+            while(!idle_.empty()){
+                PGconn* conn_ptr {idle_.back()};
+                idle_.pop_back();
+                const std::chrono::steady_clock::time_point& now {std::chrono::steady_clock::now()};
+                const connection_info& info {connections_.at(conn_ptr)};
+                if(is_expired(info,now)){
+                    recycled_.fetch_add(1,std::memory_order_relaxed);
+                    connection_discard(lock,conn_ptr);
+                    continue;
+                }
+                const bool ping {now-info.used_at>=idle_check_};
+                ++busy_;
+                lock.unlock();
+                bool reset {false};
+                const bool& ok {connection_check(conn_ptr,ping,reset)};
+                lock.lock();
+                if(!ok){
+                    --busy_;
+                    connection_discard(lock,conn_ptr);
+                    continue;
+                }
+                connection_info& checked_info {connections_.at(conn_ptr)};
+                checked_info.used_at=std::chrono::steady_clock::now();
+                if(reset){
+                    //new backend session, statements are prepared again on use
+                    checked_info.prepared.clear();
+                }
+                return conn_ptr;
+            }
+        }
+        {//open new connection while below UA_DB_POOL_SIZE_MAX
+            if(connections_.size()+opening_<pool_max_){
+                ++opening_;
+                lock.unlock();
+                PGconn* conn_ptr {connection_open(msg)};
+                lock.lock();
+                --opening_;
+                if(!conn_ptr){
+                    cv_.notify_one();
+                    return nullptr;
+                }
+                const std::chrono::steady_clock::time_point& now {std::chrono::steady_clock::now()};
+                connections_.emplace(conn_ptr,connection_info{now,now});
+                ++busy_;
+                return conn_ptr;
+            }
+        }
+        {//wait for released connection
+            ++waiters_;
+            const std::cv_status& status {cv_.wait_until(lock,deadline)};
+            --waiters_;
+            if(status==std::cv_status::timeout && idle_.empty() && connections_.size()+opening_>=pool_max_){
+                acquire_timeouts_.fetch_add(1,std::memory_order_relaxed);
+                msg="dbase pool acquire timeout";
+                return nullptr;
+            }
+        }
+    }
+}
+
+void dbase_pool::connection_release(PGconn *conn_ptr)
+{
+    if(!conn_ptr){
+        return;
+    }
+    bool reusable {PQstatus(conn_ptr)==CONNECTION_OK};
+    if(reusable){
+        //never hand out a connection with an open transaction
+        const PGTransactionStatusType& tx_status {PQtransactionStatus(conn_ptr)};
+        if(tx_status==PQTRANS_INTRANS || tx_status==PQTRANS_INERROR){
+            PGresult* res_ptr {PQexec(conn_ptr,"ROLLBACK")};
+            PQclear(res_ptr);
+        }
+        reusable=PQtransactionStatus(conn_ptr)==PQTRANS_IDLE;
+    }
+
+    std::unique_lock<std::mutex> lock {mutex_};
+    const auto& it {connections_.find(conn_ptr)};
+    if(it==connections_.end()){
+        lock.unlock();
+        PQfinish(conn_ptr);
+        return;
+    }
+    --busy_;
+    const std::chrono::steady_clock::time_point& now {std::chrono::steady_clock::now()};
+    if(!reusable || stopped_ || is_expired(it->second,now)){
+        if(reusable && !stopped_){
+            recycled_.fetch_add(1,std::memory_order_relaxed);
+        }
+        connection_discard(lock,conn_ptr);
+        return;
+    }
+    it->second.used_at=now;
+    idle_.push_back(conn_ptr);
+    cv_.notify_one();
+}
+
+PGresult *dbase_pool::statement_exec(PGconn *conn_ptr, const std::string &name, const char * const *param_values)
+{
+    const dbase_statement* statement_ptr {dbase_statements::statement_get(name)};
+    if(!statement_ptr){
+        if(logger_ptr_){
+            logger_ptr_->error("{}, statement not registered: {}",
+                BOOST_CURRENT_FUNCTION,name);
+        }
+        return NULL;
+    }
+
+    //node of a checked out connection is only touched by its owner
+    std::set<std::string>* prepared_ptr {nullptr};
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        const auto& it {connections_.find(conn_ptr)};
+        if(it!=connections_.end()){
+            prepared_ptr=&it->second.prepared;
+        }
+    }
+    if(!prepared_ptr){
+        return PQexecParams(conn_ptr,statement_ptr->sql,statement_ptr->params,NULL,param_values,NULL,NULL,0);
+    }
+
+    PGresult* res_ptr {NULL};
+    for(int attempt=0;attempt<2;++attempt){
+        {//prepare on first use
+            if(!prepared_ptr->count(name)){
+                res_ptr=PQprepare(conn_ptr,name.c_str(),statement_ptr->sql,statement_ptr->params,NULL);
+                if(PQresultStatus(res_ptr)!=PGRES_COMMAND_OK){
+                    //42P05 duplicate_prepared_statement, already on this session
+                    const char* sqlstate {PQresultErrorField(res_ptr,PG_DIAG_SQLSTATE)};
+                    if(!sqlstate || std::string {sqlstate}!="42P05"){
+                        return res_ptr;
+                    }
+                }
+                PQclear(res_ptr);
+                prepared_ptr->insert(name);
+                statements_prepared_.fetch_add(1,std::memory_order_relaxed);
+            }
+        }
+        res_ptr=PQexecPrepared(conn_ptr,name.c_str(),statement_ptr->params,param_values,NULL,NULL,0);
+        statements_executed_.fetch_add(1,std::memory_order_relaxed);
+        if(PQresultStatus(res_ptr)==PGRES_FATAL_ERROR){
+            //26000 invalid_sql_statement_name, session lost its statements (DISCARD ALL, pooler, reconnect)
+            const char* sqlstate {PQresultErrorField(res_ptr,PG_DIAG_SQLSTATE)};
+            if(attempt==0 && sqlstate && std::string {sqlstate}=="26000"){
+                PQclear(res_ptr);
+                prepared_ptr->clear();
+                statements_reprepared_.fetch_add(1,std::memory_order_relaxed);
+                continue;
+            }
+        }
+        break;
+    }
+    return res_ptr;
+}
+
+boost::json::object dbase_pool::stats_get() const
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    const boost::json::object& stats {
+        {"size_min",pool_min_},
+        {"size_max",pool_max_},
+        {"total",connections_.size()},
+        {"idle",idle_.size()},
+        {"busy",busy_},
+        {"opening",opening_},
+        {"waiters",waiters_},
+        {"connect_errors",connect_errors_.load(std::memory_order_relaxed)},
+        {"resets",resets_.load(std::memory_order_relaxed)},
+        {"recycled",recycled_.load(std::memory_order_relaxed)},
+        {"acquire_timeouts",acquire_timeouts_.load(std::memory_order_relaxed)},
+        {"statements_prepared",statements_prepared_.load(std::memory_order_relaxed)},
+        {"statements_executed",statements_executed_.load(std::memory_order_relaxed)},
+        {"statements_reprepared",statements_reprepared_.load(std::memory_order_relaxed)}
+    };
+    return stats;
+}
+
+dbase_connection::dbase_connection(std::shared_ptr<dbase_pool> dbase_pool_ptr, std::string &msg)
+    :dbase_pool_ptr_{dbase_pool_ptr},conn_ptr_{dbase_pool_ptr_->connection_acquire(msg)}
+{
+}
+
+dbase_connection::~dbase_connection()
+{
+    release();
+}
+
+PGconn *dbase_connection::get() const
+{
+    return conn_ptr_;
+}
+
+void dbase_connection::release()
+{
+    if(conn_ptr_){
+        dbase_pool_ptr_->connection_release(conn_ptr_);
+        conn_ptr_=NULL;
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef DBASE_POOL_H
+#define DBASE_POOL_H
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <condition_variable>
+#include <boost/json.hpp>
+#include <boost/asio.hpp>
+
+#include "libpq-fe.h"
+
+namespace spdlog{
+    class logger;
+}
+
+//Process-wide pool of warm PGconn*, shared by all dbase_handler instances
+class dbase_pool
+{
+private:
+    struct connection_info{
+        std::chrono::steady_clock::time_point created_at;
+        std::chrono::steady_clock::time_point used_at;
+        //names of statements prepared on this backend session
+        std::set<std::string> prepared;
+    };
+
+    boost::asio::io_context io_;
+    boost::json::object params_ {};
+    std::size_t pool_min_ {1};
+    std::size_t pool_max_ {1};
+    std::chrono::seconds max_lifetime_ {1800};
+    std::chrono::seconds idle_check_ {30};
+    std::chrono::milliseconds acquire_timeout_ {5000};
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<PGconn*> idle_ {};
+    std::map<PGconn*,connection_info> connections_ {};
+    std::size_t busy_ {0};
+    std::size_t opening_ {0};
+    std::size_t waiters_ {0};
+    bool stopped_ {false};
+
+    std::atomic<std::uint64_t> connect_errors_ {0};
+    std::atomic<std::uint64_t> resets_ {0};
+    std::atomic<std::uint64_t> recycled_ {0};
+    std::atomic<std::uint64_t> acquire_timeouts_ {0};
+    std::atomic<std::uint64_t> statements_prepared_ {0};
+    std::atomic<std::uint64_t> statements_executed_ {0};
+    std::atomic<std::uint64_t> statements_reprepared_ {0};
+
+    std::shared_ptr<spdlog::logger> logger_ptr_ {nullptr};
+
+    //Open new connection, called without lock
+    PGconn* connection_open(std::string& msg);
+    //Check connection taken from idle list, reset if broken, called without lock
+    bool connection_check(PGconn* conn_ptr,bool ping,bool& reset);
+    //Remove connection from pool and close it, called with lock
+    void connection_discard(std::unique_lock<std::mutex>& lock,PGconn* conn_ptr);
+    bool is_expired(const connection_info& info,std::chrono::steady_clock::time_point now) const;
+
+public:
+    explicit dbase_pool(const boost::json::object& params,std::size_t pool_min,std::size_t pool_max,
+                        int max_lifetime,int acquire_timeout,std::shared_ptr<spdlog::logger> logger_ptr);
+    ~dbase_pool();
+
+    //Open UA_DB_POOL_SIZE_MIN connections
+    void pool_warmup();
+    void pool_stop();
+    //Take connection from pool, nullptr and msg on failure
+    PGconn* connection_acquire(std::string& msg);
+    //Open connection outside the pool, caller owns it and closes it with PQfinish
+    PGconn* connection_dedicated(std::string& msg);
+    //Return connection to pool, broken or in-transaction connections are discarded
+    void connection_release(PGconn* conn_ptr);
+    //Run registered statement, prepared on first use per connection
+    PGresult* statement_exec(PGconn* conn_ptr,const std::string& name,const char* const* param_values);
+    boost::json::object stats_get() const;
+};
+
+//Connection taken from dbase_pool for one scope, returned on every exit path,
+//early returns and exceptions included
+class dbase_connection
+{
+private:
+    std::shared_ptr<dbase_pool> dbase_pool_ptr_ {nullptr};
+    PGconn* conn_ptr_ {NULL};
+
+public:
+    //get() is NULL and msg set when no connection could be taken
+    explicit dbase_connection(std::shared_ptr<dbase_pool> dbase_pool_ptr,std::string& msg);
+    ~dbase_connection();
+    dbase_connection(const dbase_connection&)=delete;
+    dbase_connection& operator=(const dbase_connection&)=delete;
+
+    PGconn* get() const;
+    //Return connection before the scope ends, once the last statement ran
+    void release();
+};
+
+#endif // DBASE_POOL_H
@@ -0,0 +1,107 @@
+#include "dbase_statements.h"
+
+const std::map<std::string,dbase_statement> dbase_statements::statements_ {
+    //users
+    {"user_get",{"SELECT * FROM users WHERE id=$1",1}},
+    {"user_total_get",{"SELECT count(*) FROM users",0}},
+    {"user_insert",{"INSERT INTO users (id,first_name,last_name,email,created_at,updated_at,is_blocked,phone_number,position,gender,location_id,ou_id)"
+                    " VALUES($1,$2,$3,$4,$5,$6,$7,$8,$9,$10,$11,$12)",12}},
+    {"user_update",{"UPDATE users SET first_name=$1,last_name=$2,email=$3,is_blocked=$4,updated_at=$5,"
+                    "phone_number=$6,position=$7,gender=$8,location_id=$9,ou_id=$10 WHERE id=$11",11}},
+    {"user_delete",{"DELETE FROM users WHERE id=$1",1}},
+
+    //roles_permissions
+    {"rp_get",{"SELECT * FROM roles_permissions WHERE id=$1",1}},
+    {"rp_get_by_name",{"SELECT * FROM roles_permissions WHERE name=$1",1}},
+    {"rp_uid_get_by_name",{"SELECT id FROM roles_permissions WHERE name=$1",1}},
+    {"rp_total_get",{"SELECT count(*) FROM roles_permissions",0}},
+    {"rp_insert",{"INSERT INTO roles_permissions (id,name,type,description) VALUES($1,$2,$3,$4)",4}},
+    {"rp_update",{"UPDATE roles_permissions SET name=$1,type=$2,description=$3 WHERE id=$4",4}},
+    {"rp_delete",{"DELETE FROM roles_permissions WHERE id=$1",1}},
+
+    //roles_permissions_relationship
+    {"rp_child_uids_get",{"SELECT child_id FROM roles_permissions_relationship WHERE parent_id=$1",1}},
+    {"rp_parent_uids_get",{"SELECT parent_id FROM roles_permissions_relationship WHERE child_id=$1",1}},
+    {"rp_child_insert",{"INSERT INTO roles_permissions_relationship (created_at,parent_id,child_id) VALUES($1,$2,$3)",3}},
+    {"rp_child_delete",{"DELETE FROM roles_permissions_relationship WHERE parent_id=$1 AND child_id=$2",2}},
+    {"rp_children_get",{"SELECT rp.* FROM roles_permissions_relationship rpr "
+                        "JOIN roles_permissions rp ON rp.id=rpr.child_id WHERE rpr.parent_id=$1",1}},
+
+    //authorization: UAuthAdmin granted directly, or every ident (rp_uid or name) resolves
+    //to a rp granted directly or inherited through roles_permissions_relationship
+    {"authz_check",{"WITH RECURSIVE granted AS ("
+                    "SELECT role_permission_id AS rp_id FROM users_roles_permissions WHERE user_id=$1::uuid "
+                    "UNION "
+                    "SELECT rpr.child_id FROM roles_permissions_relationship rpr JOIN granted g ON rpr.parent_id=g.rp_id"
+                    "), requested AS ("
+                    "SELECT DISTINCT ident FROM unnest($2::text[]) AS ident"
+                    "), resolved AS ("
+                    "SELECT q.ident, rp.id FROM requested q "
+                    "LEFT JOIN roles_permissions rp ON rp.name=q.ident OR rp.id::text=q.ident"
+                    ") SELECT EXISTS ("
+                    "SELECT 1 FROM users_roles_permissions urp JOIN roles_permissions rp ON rp.id=urp.role_permission_id "
+                    "WHERE urp.user_id=$1::uuid AND rp.name='UAuthAdmin'"
+                    ") OR (EXISTS (SELECT 1 FROM requested) AND NOT EXISTS ("
+                    "SELECT 1 FROM resolved r WHERE r.id IS NULL OR r.id NOT IN (SELECT rp_id FROM granted)"
+                    "))",2}},
+    //batch of checks, one row per (entry, ident); granted closure is walked once per distinct user,
+    //returns entry index and decision, same rules as authz_check
+    {"authz_batch_check",{"WITH RECURSIVE requested AS ("
+                          "SELECT q.n, q.user_id::uuid AS user_id, q.ident FROM unnest($1::int[],$2::text[],$3::text[]) AS q(n,user_id,ident)"
+                          "), users_ AS ("
+                          "SELECT DISTINCT user_id FROM requested"
+                          "), granted AS ("
+                          "SELECT urp.user_id, urp.role_permission_id AS rp_id FROM users_roles_permissions urp JOIN users_ u ON u.user_id=urp.user_id "
+                          "UNION "
+                          "SELECT g.user_id, rpr.child_id FROM roles_permissions_relationship rpr JOIN granted g ON rpr.parent_id=g.rp_id"
+                          "), admins AS ("
+                          "SELECT DISTINCT urp.user_id FROM users_roles_permissions urp JOIN users_ u ON u.user_id=urp.user_id "
+                          "JOIN roles_permissions rp ON rp.id=urp.role_permission_id WHERE rp.name='UAuthAdmin'"
+                          "), resolved AS ("
+                          "SELECT q.n, q.user_id, rp.id FROM requested q "
+                          "LEFT JOIN roles_permissions rp ON rp.name=q.ident OR rp.id::text=q.ident"
+                          ") SELECT r.n, bool_and(r.user_id IN (SELECT user_id FROM admins) OR (r.id IS NOT NULL AND EXISTS ("
+                          "SELECT 1 FROM granted g WHERE g.user_id=r.user_id AND g.rp_id=r.id"
+                          "))) FROM resolved r GROUP BY r.n",3}},
+
+    //transitive rps of one user, admin only for a directly granted UAuthAdmin as in authz_check
+    {"user_effective_get",{"WITH RECURSIVE granted AS ("
+                           "SELECT role_permission_id AS rp_id, true AS direct FROM users_roles_permissions WHERE user_id=$1::uuid "
+                           "UNION "
+                           "SELECT rpr.child_id, false FROM roles_permissions_relationship rpr JOIN granted g ON rpr.parent_id=g.rp_id"
+                           ") SELECT rp.id, rp.name, bool_or(g.direct) AND rp.name='UAuthAdmin' AS admin "
+                           "FROM granted g JOIN roles_permissions rp ON rp.id=g.rp_id GROUP BY rp.id, rp.name",1}},
+
+    //authz_engine snapshot load
+    {"authz_rp_all",{"SELECT id, name FROM roles_permissions",0}},
+    {"authz_rpr_all",{"SELECT parent_id, child_id FROM roles_permissions_relationship",0}},
+    {"authz_urp_all",{"SELECT user_id, role_permission_id FROM users_roles_permissions",0}},
+
+    //users_roles_permissions
+    {"urp_total_by_user_get",{"SELECT count(*) FROM users_roles_permissions WHERE user_id=$1",1}},
+    {"urp_total_by_rp_get",{"SELECT count(*) FROM users_roles_permissions WHERE role_permission_id=$1",1}},
+    {"urp_rp_uids_get",{"SELECT role_permission_id FROM users_roles_permissions WHERE user_id=$1",1}},
+    {"urp_user_uids_get",{"SELECT user_id FROM users_roles_permissions WHERE role_permission_id=$1",1}},
+    //page of assigned rps or users in one round trip, NULL limit/offset means no LIMIT/OFFSET
+    {"urp_rps_page_get",{"SELECT rp.* FROM users_roles_permissions urp "
+                         "JOIN roles_permissions rp ON rp.id=urp.role_permission_id WHERE urp.user_id=$1 "
+                         "ORDER BY urp.created_at, rp.id LIMIT $2 OFFSET $3",3}},
+    {"urp_users_page_get",{"SELECT u.* FROM users_roles_permissions urp "
+                           "JOIN users u ON u.id=urp.user_id WHERE urp.role_permission_id=$1 "
+                           "ORDER BY urp.created_at, u.id LIMIT $2 OFFSET $3",3}},
+    {"urp_total_get",{"SELECT count(*) FROM users_roles_permissions",0}},
+    {"urp_insert",{"INSERT INTO users_roles_permissions (created_at,user_id,role_permission_id) VALUES($1,$2,$3)",3}},
+    {"urp_delete",{"DELETE FROM users_roles_permissions WHERE user_id=$1 AND role_permission_id=$2",2}},
+
+    //table_counters, maintained by triggers created in uatables
+    {"counter_get",{"SELECT row_count FROM table_counters WHERE table_name=$1",1}}
+};
+
+const dbase_statement *dbase_statements::statement_get(const std::string &name)
+{
+    const auto& it {statements_.find(name)};
+    if(it==statements_.end()){
+        return nullptr;
+    }
+    return &it->second;
+}
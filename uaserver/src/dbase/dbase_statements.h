@@ -0,0 +1,24 @@
+#ifndef DBASE_STATEMENTS_H
+#define DBASE_STATEMENTS_H
+
+#include <map>
+#include <string>
+
+struct dbase_statement
+{
+    const char* sql;
+    int params;
+};
+
+//Registry of fixed SQL, prepared once per pooled connection under its name
+class dbase_statements
+{
+private:
+    static const std::map<std::string,dbase_statement> statements_;
+
+public:
+    //nullptr if name is not registered
+    static const dbase_statement* statement_get(const std::string& name);
+};
+
+#endif // DBASE_STATEMENTS_H
@@ -0,0 +1,97 @@
+#include "task_executor.h"
+
+#include <algorithm>
+#include "spdlog/spdlog.h"
+
+void task_executor::max_update(std::atomic<std::uint64_t> &max, std::uint64_t value)
+{
+    std::uint64_t current {max.load(std::memory_order_relaxed)};
+    while(value>current && !max.compare_exchange_weak(current,value,std::memory_order_relaxed)){
+    }
+}
+
+void task_executor::task_run(const std::function<void()> &task, std::chrono::steady_clock::time_point posted_at)
+{
+    const std::uint64_t& wait_us {static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                      std::chrono::steady_clock::now()-posted_at).count())};
+    wait_us_total_.fetch_add(wait_us,std::memory_order_relaxed);
+    max_update(wait_us_max_,wait_us);
+    queue_depth_.fetch_sub(1,std::memory_order_relaxed);
+
+    const std::chrono::steady_clock::time_point& started_at {std::chrono::steady_clock::now()};
+    try{
+        task();
+    }
+    catch(const std::exception& ex){
+        if(logger_ptr_){
+            logger_ptr_->error("{}, executor: {}, task failed: {}",
+                BOOST_CURRENT_FUNCTION,name_,ex.what());
+        }
+    }
+    catch(...){
+        if(logger_ptr_){
+            logger_ptr_->error("{}, executor: {}, task failed: unknown exception",
+                BOOST_CURRENT_FUNCTION,name_);
+        }
+    }
+    const std::uint64_t& run_us {static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now()-started_at).count())};
+    run_us_total_.fetch_add(run_us,std::memory_order_relaxed);
+    max_update(run_us_max_,run_us);
+    completed_.fetch_add(1,std::memory_order_relaxed);
+}
+
+task_executor::task_executor(const std::string &name, std::size_t threads, std::size_t queue_max, std::shared_ptr<spdlog::logger> logger_ptr)
+    :name_{name},threads_{std::max<std::size_t>(1,threads)},queue_max_{std::max<std::size_t>(1,queue_max)},
+     pool_{threads_},logger_ptr_{logger_ptr}
+{
+}
+
+task_executor::~task_executor()
+{
+    executor_stop();
+}
+
+bool task_executor::task_post(std::function<void()> task)
+{
+    const std::size_t& depth {queue_depth_.fetch_add(1,std::memory_order_relaxed)+1};
+    if(depth>queue_max_){
+        queue_depth_.fetch_sub(1,std::memory_order_relaxed);
+        rejected_.fetch_add(1,std::memory_order_relaxed);
+        return false;
+    }
+    {//update queue depth peak
+        std::size_t peak {queue_depth_peak_.load(std::memory_order_relaxed)};
+        while(depth>peak && !queue_depth_peak_.compare_exchange_weak(peak,depth,std::memory_order_relaxed)){
+        }
+    }
+    const std::chrono::steady_clock::time_point& posted_at {std::chrono::steady_clock::now()};
+    boost::asio::post(pool_,std::bind(&task_executor::task_run,this,std::move(task),posted_at));
+    return true;
+}
+
+void task_executor::executor_stop()
+{
+    pool_.stop();
+    pool_.join();
+}
+
+boost::json::object task_executor::stats_get() const
+{
+    const std::uint64_t& completed {completed_.load(std::memory_order_relaxed)};
+    const std::uint64_t& wait_us_total {wait_us_total_.load(std::memory_order_relaxed)};
+    const std::uint64_t& run_us_total {run_us_total_.load(std::memory_order_relaxed)};
+    const boost::json::object& stats {
+        {"threads",threads_},
+        {"queue_max",queue_max_},
+        {"queue_depth",queue_depth_.load(std::memory_order_relaxed)},
+        {"queue_depth_peak",queue_depth_peak_.load(std::memory_order_relaxed)},
+        {"completed",completed},
+        {"rejected",rejected_.load(std::memory_order_relaxed)},
+        {"wait_avg_us",completed ? wait_us_total/completed : 0},
+        {"wait_max_us",wait_us_max_.load(std::memory_order_relaxed)},
+        {"run_avg_us",completed ? run_us_total/completed : 0},
+        {"run_max_us",run_us_max_.load(std::memory_order_relaxed)}
+    };
+    return stats;
+}
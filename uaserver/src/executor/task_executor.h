@@ -0,0 +1,50 @@
+#ifndef TASK_EXECUTOR_H
+#define TASK_EXECUTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <functional>
+#include <boost/asio.hpp>
+#include <boost/json.hpp>
+
+namespace spdlog{
+    class logger;
+}
+
+//Bounded worker pool for blocking work (libpq calls, crypto) kept off the I/O threads
+class task_executor
+{
+private:
+    std::string name_ {};
+    std::size_t threads_ {1};
+    std::size_t queue_max_ {1};
+    boost::asio::thread_pool pool_;
+
+    std::atomic<std::size_t> queue_depth_ {0};
+    std::atomic<std::size_t> queue_depth_peak_ {0};
+    std::atomic<std::uint64_t> completed_ {0};
+    std::atomic<std::uint64_t> rejected_ {0};
+    std::atomic<std::uint64_t> wait_us_total_ {0};
+    std::atomic<std::uint64_t> wait_us_max_ {0};
+    std::atomic<std::uint64_t> run_us_total_ {0};
+    std::atomic<std::uint64_t> run_us_max_ {0};
+
+    std::shared_ptr<spdlog::logger> logger_ptr_ {nullptr};
+
+    static void max_update(std::atomic<std::uint64_t>& max,std::uint64_t value);
+    void task_run(const std::function<void()>& task,std::chrono::steady_clock::time_point posted_at);
+
+public:
+    explicit task_executor(const std::string& name,std::size_t threads,std::size_t queue_max,std::shared_ptr<spdlog::logger> logger_ptr);
+    ~task_executor();
+
+    //Queue task, false if the queue is full
+    bool task_post(std::function<void()> task);
+    void executor_stop();
+    boost::json::object stats_get() const;
+};
+
+#endif // TASK_EXECUTOR_H
@@ -1,6 +1,7 @@
 #include <string>
 #include <thread>
 #include <vector>
+#include <algorithm>
 #include <cstdlib>
 #include <boost/asio.hpp>
 #include <boost/json.hpp>
@@ -9,6 +10,7 @@
 #include <boost/asio/signal_set.hpp>
 
 #include "bootloader.h"
+#include "settings/app_settings.h"
 
 #if BOOST_OS_WINDOWS
 void set_env()
@@ -98,7 +100,9 @@ int main(int argc,char* argv[])
 #endif
     boost::filesystem::path path_ {argv[0]};
     const std::string& app_dir {path_.remove_filename().string()};
-    const unsigned int& max_threads {std::thread::hardware_concurrency()-1};
+    //"sharded" io model runs sessions on per-core io shards, shared io keeps the main thread only
+    const bool& io_sharded {app_settings::io_model_get()=="sharded"};
+    const unsigned int& max_threads {io_sharded ? 0u : std::max(1u,std::thread::hardware_concurrency())-1};
 
     boost::asio::io_context io;
     boost::asio::signal_set signals {io,SIGINT,SIGTERM};
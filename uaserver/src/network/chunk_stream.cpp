@@ -0,0 +1,71 @@
+#include "chunk_stream.h"
+
+#include <algorithm>
+
+chunk_stream::chunk_stream(std::size_t chunks_max, std::function<void()> notify)
+    :chunks_max_{std::max<std::size_t>(1,chunks_max)},notify_{notify}
+{
+}
+
+bool chunk_stream::chunk_push(std::string &&chunk)
+{
+    {
+        std::unique_lock<std::mutex> lock {mutex_};
+        cv_.wait(lock,[this](){
+            return cancelled_ || chunks_.size()<chunks_max_;
+        });
+        if(cancelled_){
+            return false;
+        }
+        chunks_.push_back(std::move(chunk));
+        begun_=true;
+    }
+    notify_();
+    return true;
+}
+
+void chunk_stream::stream_finish(bool failed)
+{
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        if(!begun_ || cancelled_){
+            return;
+        }
+        finished_=true;
+        failed_=failed;
+    }
+    notify_();
+}
+
+bool chunk_stream::is_begun()
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    return begun_;
+}
+
+chunk_state chunk_stream::chunk_pop(std::string &chunk)
+{
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        if(chunks_.empty()){
+            if(!finished_){
+                return chunk_state::empty;
+            }
+            return failed_ ? chunk_state::failed : chunk_state::finished;
+        }
+        chunk.swap(chunks_.front());
+        chunks_.pop_front();
+    }
+    cv_.notify_one();
+    return chunk_state::chunk;
+}
+
+void chunk_stream::stream_cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        cancelled_=true;
+        chunks_.clear();
+    }
+    cv_.notify_all();
+}
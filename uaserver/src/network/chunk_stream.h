@@ -0,0 +1,50 @@
+#ifndef CHUNK_STREAM_H
+#define CHUNK_STREAM_H
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <functional>
+#include <condition_variable>
+
+enum class chunk_state{
+    chunk,
+    empty,
+    finished,
+    failed
+};
+
+//Bounded queue between a dbase executor producer and the session writer,
+//producer waits while full, writer pops after each async_write completes
+class chunk_stream
+{
+private:
+    std::size_t chunks_max_ {4};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::string> chunks_ {};
+    bool begun_ {false};
+    bool finished_ {false};
+    bool failed_ {false};
+    bool cancelled_ {false};
+    //posts the writer on the session executor, called without lock
+    std::function<void()> notify_ {};
+
+public:
+    explicit chunk_stream(std::size_t chunks_max,std::function<void()> notify);
+    ~chunk_stream()=default;
+
+    //Producer: queue chunk, waits while queue is full, false if writer cancelled
+    bool chunk_push(std::string&& chunk);
+    //Producer: no more chunks, failed ends the response without last chunk
+    void stream_finish(bool failed);
+    //True once first chunk was queued, response headers belong to the stream
+    bool is_begun();
+
+    //Writer: take next chunk without waiting
+    chunk_state chunk_pop(std::string& chunk);
+    //Writer: peer gone, wake producer
+    void stream_cancel();
+};
+
+#endif // CHUNK_STREAM_H
@@ -1,277 +1,283 @@
 #include "http_handler.h"
 #include "dbase/dbase_handler.h"
 #include "x509/x509_generator.h"
+#include "x509/x509_keystore.h"
+#include "x509/x509_keypair_pool.h"
+#include "dbase/dbase_pool.h"
+#include "authz/authz_engine.h"
+#include "authz/authz_cache.h"
+#include "executor/task_executor.h"
 
 #include <algorithm>
-#include <boost/url.hpp>
 #include <boost/json.hpp>
-#include <boost/regex.hpp>
 #include <boost/algorithm/string.hpp>
 #include "spdlog/spdlog.h"
 
-http::response<http::string_body> http_handler::fail(http::request<http::string_body> &&request,http::status code,const std::string &body)
+const http_router http_handler::router_ {};
+
+http::response<http::string_body> http_handler::fail(http::request<http::string_body> &&request,http::status code,std::string body)
 {
-    body_ptr_.reset(new std::string{body});
     http::response<http::string_body> response {code,request.version()};
     response.keep_alive(request.keep_alive());
     response.set(http::field::server, BOOST_BEAST_VERSION_STRING);
     response.set(http::field::content_type,"application/json");
-    response.set(http::field::content_length,std::to_string(body_ptr_->size()));
-    response.body()=*body_ptr_;
+    response.body()=std::move(body);
     response.prepare_payload();
     return response;
 }
 
-http::response<http::string_body> http_handler::success(http::request<http::string_body> &&request,http::status code, const std::string &body)
+http::response<http::string_body> http_handler::success(http::request<http::string_body> &&request,http::status code,std::string body)
 {
-    body_ptr_.reset(new std::string{body});
     http::response<http::string_body> response {code,request.version()};
     response.keep_alive(request.keep_alive());
     response.set(http::field::server, BOOST_BEAST_VERSION_STRING);
     response.set(http::field::content_type,"application/json");
-    response.set(http::field::content_length,std::to_string(body_ptr_->size()));
-    response.body()=*body_ptr_;
+    response.body()=std::move(body);
     response.prepare_payload();
     return response;
 }
 
-http::response<http::string_body> http_handler::handle_user(http::request<http::string_body> &&request, const std::string &requester_id)
+http::message_generator http_handler::handle_unavailable(http::request<http::string_body> &&request)
 {
-    //verb check
-    if((request.method()!=http::verb::get) & (request.method()!=http::verb::put) &
-       (request.method()!=http::verb::post) & (request.method()!=http::verb::delete_)){
-        return fail(std::move(request),http::status::not_found,"not found");
-    }
-    switch(request.method()){
-    case http::verb::get:
-        return handle_user_get(std::move(request),requester_id);
-    case http::verb::put:
-        return handle_user_put(std::move(request),requester_id);
-    case http::verb::post:
-        return handle_user_post(std::move(request),requester_id);
-    case http::verb::delete_:
-        return handle_user_delete(std::move(request),requester_id);
-    default:
-        return fail(std::move(request),http::status::not_found,"not found");
-    }
-    return fail(std::move(request),http::status::bad_request,"bad request");
+    http::response<http::string_body> response {fail(std::move(request),http::status::service_unavailable,"service_unavailable")};
+    response.set(http::field::retry_after,"1");
+    return response;
+}
+
+http::message_generator http_handler::handle_internal_error(http::request<http::string_body> &&request)
+{
+    return fail(std::move(request),http::status::internal_server_error,"internal_server_error");
 }
 
-http::response<http::string_body> http_handler::handle_authz(http::request<http::string_body> &&request, const std::string &requester_id)
+bool http_handler::is_streamed(const http::request<http::string_body> &request) const
 {
-    //verb check
-    if(request.method()!=http::verb::get){
-        return fail(std::move(request),http::status::bad_request,"bad request");
+    if(!context_.stream_lists || request.version()!=11 || request.method()!=http::verb::get){
+        return false;
+    }
+    switch(router_.route_find(request.method(),request.target()).id){
+    case route_id::users_list_get:
+    case route_id::rps_list_get:
+    case route_id::rp_users_get:
+        return true;
+    default:
+        return false;
     }
-    return handle_authz_get(std::move(request),requester_id);
 }
 
-http::response<http::string_body> http_handler::handle_authz_manage(http::request<http::string_body> &&request, const std::string &requester_id)
+bool http_handler::is_crypto(const http::request<http::string_body> &request) const
 {
-    //verb check
-    if((request.method()!=http::verb::post) & (request.method()!=http::verb::delete_)){
-        return fail(std::move(request),http::status::not_found,"not found");
+    if(!context_.crypto_executor_ptr || request.method()!=http::verb::post){
+        return false;
     }
-    switch(request.method()){
-    case http::verb::post:
-        return handle_authz_manage_post(std::move(request),requester_id);
-    case http::verb::delete_:
-        return handle_authz_manage_delete(std::move(request),requester_id);
+    switch(router_.route_find(request.method(),request.target()).id){
+    case route_id::certificate_user_post:
+    case route_id::certificate_agent_post:
+        return true;
     default:
-        return fail(std::move(request),http::status::not_found,"not found");
+        return false;
     }
-    return fail(std::move(request),http::status::not_found,"not found");
 }
 
-http::response<http::string_body> http_handler::handle_rp(http::request<http::string_body> &&request, const std::string &requester_id)
+void http_handler::query_map_get(boost::beast::string_view query, std::map<std::string, std::string> &query_map)
 {
-    //verb check
-    if((request.method()!=http::verb::get) & (request.method()!=http::verb::put) &
-       (request.method()!=http::verb::post) & (request.method()!=http::verb::delete_)){
-        return fail(std::move(request),http::status::not_found,"not found");
+    std::size_t begin {0};
+    while(begin<query.size()){
+        std::size_t end {query.find('&',begin)};
+        if(end==boost::beast::string_view::npos){
+            end=query.size();
+        }
+        const boost::beast::string_view& query_item {query.substr(begin,end-begin)};
+        const std::size_t& pos {query_item.find('=')};
+        if(pos!=boost::beast::string_view::npos){
+            query_map.emplace(std::string {query_item.substr(0,pos)},std::string {query_item.substr(pos+1)});
+        }
+        begin=end+1;
     }
-    switch(request.method()){
-    case http::verb::get:
-        return handle_rp_get(std::move(request),requester_id);
-    case http::verb::put:
-        return handle_rp_put(std::move(request),requester_id);
-    case http::verb::post:
+}
+
+http::response<http::string_body> http_handler::handle_route(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id, chunk_stream *stream_ptr)
+{
+    switch(match.id){
+    case route_id::users_list_get:
+        return handle_users_list_get(std::move(request),match,requester_id,stream_ptr);
+    case route_id::user_get:
+        return handle_user_get(std::move(request),match,requester_id);
+    case route_id::user_rps_get:
+        return handle_user_rps_get(std::move(request),match,requester_id);
+    case route_id::user_effective_get:
+        return handle_user_effective_get(std::move(request),match,requester_id);
+    case route_id::user_put:
+        return handle_user_put(std::move(request),match,requester_id);
+    case route_id::user_post:
+        return handle_user_post(std::move(request),requester_id);
+    case route_id::user_delete:
+        return handle_user_delete(std::move(request),match,requester_id);
+    case route_id::authz_get:
+        return handle_authz_get(std::move(request),match,requester_id);
+    case route_id::authz_batch_post:
+        return handle_authz_batch_post(std::move(request),requester_id);
+    case route_id::authz_manage_post:
+        return handle_authz_manage_post(std::move(request),match,requester_id);
+    case route_id::authz_manage_delete:
+        return handle_authz_manage_delete(std::move(request),match,requester_id);
+    case route_id::rps_list_get:
+        return handle_rps_list_get(std::move(request),match,requester_id,stream_ptr);
+    case route_id::rp_get:
+        return handle_rp_get(std::move(request),match,requester_id);
+    case route_id::rp_detail_get:
+        return handle_rp_detail_get(std::move(request),match,requester_id);
+    case route_id::rp_users_get:
+        return handle_rp_users_get(std::move(request),match,requester_id,stream_ptr);
+    case route_id::rp_put:
+        return handle_rp_put(std::move(request),match,requester_id);
+    case route_id::rp_child_put:
+        return handle_rp_child_put(std::move(request),match,requester_id);
+    case route_id::rp_post:
         return handle_rp_post(std::move(request),requester_id);
-    case http::verb::delete_:
-        return handle_rp_delete(std::move(request),requester_id);
+    case route_id::rp_delete:
+        return handle_rp_delete(std::move(request),match,requester_id);
+    case route_id::rp_child_delete:
+        return handle_rp_child_delete(std::move(request),match,requester_id);
+    case route_id::certificate_user_post:
+        return handle_certificate_user_post(std::move(request),match,requester_id);
+    case route_id::certificate_agent_post:
+        return handle_certificate_agent_post(std::move(request),requester_id);
+    case route_id::metrics_get:
+        return handle_metrics_get(std::move(request),requester_id);
     default:
         return fail(std::move(request),http::status::not_found,"not found");
     }
-    return fail(std::move(request),http::status::bad_request,"bad request");
 }
 
-http::response<http::string_body> http_handler::handle_certificate(http::request<http::string_body> &&request, const std::string &requester_id)
+http::response<http::string_body> http_handler::handle_users_list_get(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id, chunk_stream *stream_ptr)
 {
-    if(request.method()==http::verb::post){
-        return handle_certificate_post(std::move(request),requester_id);
+    std::map<std::string,std::string> query_map {};
+    if(match.query.empty()){
+        query_map.emplace("limit","100");
+        query_map.emplace("offset","0");
+    }
+    else{
+        query_map_get(match.query,query_map);
+    }
+
+    std::string msg {};
+    std::string users {};
+    const db_status& status_ {dbase_handler_.user_list_get(users,query_map,requester_id,stream_ptr,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::ok,std::move(users));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
     }
-    return fail(std::move(request),http::status::bad_request,"bad request");
 }
 
-http::response<http::string_body> http_handler::handle_user_get(http::request<http::string_body> &&request, const std::string &requester_id)
+http::response<http::string_body> http_handler::handle_user_get(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id)
 {
-    const std::string& target {request.target()};
-    {//users list
-        boost::regex re {"^/api/v1/u-auth/users$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){
-            std::string msg {};
-            std::string users {};
-            std::map<std::string,std::string> query_map {
-                {"limit","100"},
-                {"offset","0"}
-            };
+    const std::string& user_uid {match.captures[0]};
+    std::string msg {};
+    std::string user {};
 
-            const db_status& status_ {dbase_handler_ptr_->user_list_get(users,query_map,requester_id,msg)};
-            switch(status_){
-            case db_status::fail:
-                return fail(std::move(request),http::status::bad_request,msg);
-            case db_status::success:
-                return success(std::move(request),http::status::ok,users);
-            case db_status::not_found:
-                return fail(std::move(request),http::status::not_found,msg);
-            case db_status::unauthorized:
-                return fail(std::move(request),http::status::unauthorized,msg);
-            default:
-                return fail(std::move(request),http::status::bad_request,msg);
-            }
-        }
+    const db_status& status_ {dbase_handler_.user_info_get(user_uid,user,requester_id,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::ok,std::move(user));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
     }
-    {//user by user_uid
-        boost::regex re {"^/api/v1/u-auth/users/" + regex_uid_ + "$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){
-            const std::string& user_uid {match[1]};
-            std::string msg {};
-            std::string user {};
-
-            const db_status& status_ {dbase_handler_ptr_->user_info_get(user_uid,user,requester_id,msg)};
-            switch(status_){
-            case db_status::fail:
-                return fail(std::move(request),http::status::bad_request,msg);
-            case db_status::success:
-                return success(std::move(request),http::status::ok,user);
-            case db_status::not_found:
-                return fail(std::move(request),http::status::not_found,msg);
-            case db_status::unauthorized:
-                return fail(std::move(request),http::status::unauthorized,msg);
-            default:
-                return fail(std::move(request),http::status::bad_request,msg);
-            }
-        }
+}
+
+http::response<http::string_body> http_handler::handle_user_rps_get(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id)
+{
+    const std::string& user_uid {match.captures[0]};
+    std::string msg {};
+    std::string rps {};
+
+    std::map<std::string,std::string> query_map {};
+    query_map_get(match.query,query_map);
+    //checked as for the list endpoints, postgres errors never reach the body; no limit returns all
+    int limit {0};
+    int offset {0};
+    if(!dbase_handler::paging_check(query_map,limit,offset,msg)){
+        return fail(std::move(request),http::status::bad_request,msg);
     }
-    {//user's roles_permissions
-        boost::regex re {"^/api/v1/u-auth/users/" + regex_uid_ + "/roles-permissions" + regex_any_ + "$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){
-            const std::string& user_uid {match[1]};
-            std::string msg {};
-            std::string rps {};
-
-            std::string limit {};
-            std::string offset {};
-            boost::url url_ {target};
-            auto query=url_.query();
-            if(!query.empty()){
-                boost::urls::result<boost::urls::params_encoded_view> result=boost::urls::parse_query(query);
-                if(!result.has_error()){
-                    const boost::urls::params_encoded_view& view {result.value()};
-                    if(view.contains("limit")){
-                        auto it {view.find("limit")};
-                        limit=std::string {it->value};
-                    }
-                    if(view.contains("offset")){
-                        auto it {view.find("offset")};
-                        offset=std::string {it->value};
-                    }
-                }
-            }
-            //not need to check limit and offset
-            const db_status& status_ {dbase_handler_ptr_->user_rp_get(user_uid,limit,offset,rps,requester_id,msg)};
-            switch(status_){
-            case db_status::fail:
-                return fail(std::move(request),http::status::bad_request,msg);
-            case db_status::success:
-                return success(std::move(request),http::status::ok,rps);
-            case db_status::not_found:
-                return fail(std::move(request),http::status::not_found,msg);
-            case db_status::unauthorized:
-                return fail(std::move(request),http::status::unauthorized,msg);
-            default:
-                return fail(std::move(request),http::status::bad_request,msg);
-            }
-        }
+
+    const db_status& status_ {dbase_handler_.user_rp_get(user_uid,limit,offset,rps,requester_id,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::ok,std::move(rps));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
     }
-    {//users list with limit and/or offset and filter
-        boost::regex re {"^/api/v1/u-auth/users" + regex_any_ + "$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){
-            std::map<std::string,std::string> query_map {};
-            std::size_t pos {target.find('?')};
-            if(pos!=std::string::npos){
-                ++pos;
-                const std::string& query {target.substr(pos,target.size()-pos)};
-                std::vector<std::string> query_items {};
-                boost::split(query_items,query,boost::is_any_of("&"));
-                for(const std::string& query_item: query_items){
-                    std::vector<std::string> query_item_split {};
-                    boost::split(query_item_split,query_item,boost::is_any_of("="));
-                    if(query_item_split.size()==2){
-                        query_map.emplace(query_item_split.at(0),query_item_split.at(1));
-                    }
-                }
-            }
-
-            std::string msg {};
-            std::string users {};
-            const db_status& status_ {dbase_handler_ptr_->user_list_get(users,query_map,requester_id,msg)};
-            switch(status_){
-            case db_status::fail:
-                return fail(std::move(request),http::status::bad_request,msg);
-            case db_status::success:
-                return success(std::move(request),http::status::ok,users);
-            case db_status::not_found:
-                return fail(std::move(request),http::status::not_found,msg);
-            case db_status::unauthorized:
-                return fail(std::move(request),http::status::unauthorized,msg);
-            default:
-                return fail(std::move(request),http::status::bad_request,msg);
-            }
-        }
+}
+
+http::response<http::string_body> http_handler::handle_user_effective_get(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id)
+{
+    const std::string& user_uid {match.captures[0]};
+    std::string msg {};
+    std::string effective {};
+    std::string version {};
+
+    const db_status& status_ {dbase_handler_.user_effective_get(user_uid,effective,version,requester_id,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:{
+        const std::string& etag {"\"" + version + "\""};
+        const auto& it {request.base().find(http::field::if_none_match)};
+        const bool& not_modified {it!=request.base().end() && (it->value()==etag || it->value()=="*")};
+        http::response<http::string_body> response {not_modified ? success(std::move(request),http::status::not_modified,std::string {})
+                                                                 : success(std::move(request),http::status::ok,std::move(effective))};
+        response.set(http::field::etag,etag);
+        //clients may keep the set, revalidating with If-None-Match
+        response.set(http::field::cache_control,"private, no-cache");
+        return response;
+    }
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
     }
-    return fail(std::move(request),http::status::not_found,"not found");
 }
 
-http::response<http::string_body> http_handler::handle_user_put(http::request<http::string_body> &&request, const std::string &requester_id)
+http::response<http::string_body> http_handler::handle_user_put(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id)
 {
-    const std::string& target {request.target()};
-    boost::regex re {"^/api/v1/u-auth/users/" + regex_uid_ + "$"};
-    boost::smatch match;
-    if(boost::regex_match(target,match,re)){
-        std::string msg;
-        const std::string& user_uid {match[1]};
-        const std::string& body {request.body()};
+    std::string msg;
+    const std::string& user_uid {match.captures[0]};
+    const std::string& body {request.body()};
 
-        const db_status& status_ {dbase_handler_ptr_->user_info_put(user_uid,body,requester_id,msg)};
-        switch(status_){
-        case db_status::fail:
-            return fail(std::move(request),http::status::bad_request,msg);
-        case db_status::success:
-            return success(std::move(request),http::status::ok,msg);
-        case db_status::not_found:
-            return fail(std::move(request),http::status::not_found,msg);
-        case db_status::unauthorized:
-            return fail(std::move(request),http::status::unauthorized,msg);
-        default:
-            return fail(std::move(request),http::status::bad_request,msg);
-        }
+    const db_status& status_ {dbase_handler_.user_info_put(user_uid,body,requester_id,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::ok,std::move(msg));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
     }
-    return fail(std::move(request),http::status::not_found,"not found");
 }
 
 http::response<http::string_body> http_handler::handle_user_post(http::request<http::string_body> &&request, const std::string &requester_id)
@@ -279,12 +285,12 @@ http::response<http::string_body> http_handler::handle_user_post(http::request<h
     std::string msg;
     const std::string& body {request.body()};
 
-    const db_status& status_ {dbase_handler_ptr_->user_info_post(body,requester_id,msg)};
+    const db_status& status_ {dbase_handler_.user_info_post(body,requester_id,msg)};
     switch(status_){
     case db_status::fail:
         return fail(std::move(request),http::status::bad_request,msg);
     case db_status::success:
-        return success(std::move(request),http::status::ok,msg);
+        return success(std::move(request),http::status::ok,std::move(msg));
     case db_status::not_found:
         return fail(std::move(request),http::status::not_found,msg);
     case db_status::unauthorized:
@@ -292,26 +298,19 @@ http::response<http::string_body> http_handler::handle_user_post(http::request<h
     default:
         return fail(std::move(request),http::status::bad_request,msg);
     }
-    return fail(std::move(request),http::status::not_found,"not found");
 }
 
-http::response<http::string_body> http_handler::handle_user_delete(http::request<http::string_body> &&request, const std::string &requester_id)
+http::response<http::string_body> http_handler::handle_user_delete(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id)
 {
-    const std::string& target {request.target()};
-    boost::regex re {"^/api/v1/u-auth/users/" + regex_uid_ + "$"};
-    boost::smatch match;
-    if(!boost::regex_match(target,match,re)){
-        return fail(std::move(request),http::status::bad_request,"bad request");
-    }
     std::string msg;
-    const std::string& user_uid {match[1]};
+    const std::string& user_uid {match.captures[0]};
 
-    const db_status& status_ {dbase_handler_ptr_->user_info_delete(user_uid,requester_id,msg)};
+    const db_status& status_ {dbase_handler_.user_info_delete(user_uid,requester_id,msg)};
     switch(status_){
     case db_status::fail:
         return fail(std::move(request),http::status::bad_request,msg);
     case db_status::success:
-        return success(std::move(request),http::status::no_content,msg);
+        return success(std::move(request),http::status::no_content,std::move(msg));
     case db_status::not_found:
         return fail(std::move(request),http::status::not_found,msg);
     case db_status::unauthorized:
@@ -319,331 +318,240 @@ http::response<http::string_body> http_handler::handle_user_delete(http::request
     default:
         return fail(std::move(request),http::status::bad_request,msg);
     }
-    return fail(std::move(request),http::status::not_found,msg);
 }
 
-http::response<http::string_body> http_handler::handle_authz_get(http::request<http::string_body> &&request, const std::string &requester_id)
+http::response<http::string_body> http_handler::handle_authz_get(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id)
 {
     boost::ignore_unused(requester_id);
-    const std::string& target {request.target()};
-    boost::regex re {"^/api/v1/u-auth/authz/" + regex_uid_+ "/authorized-to/" + regex_any_ + "$"};
-    boost::smatch match;
-    if(boost::regex_match(target,match,re)){
-        std::string msg {};
-        bool authorized {false};
-        const std::string& user_uid {match[1]};
-        const std::string& rp_ident {match[2]};
+    std::string msg {};
+    bool authorized {false};
+    const std::string& user_uid {match.captures[0]};
+    const std::string& rp_ident {match.captures[1]};
 
-        const db_status& status_ {dbase_handler_ptr_->authz_check_get(user_uid,rp_ident,authorized,msg)};
-        switch(status_){
-        case db_status::fail:
-            return fail(std::move(request),http::status::bad_request,msg);
-        case db_status::success:
-            return success(std::move(request),http::status::ok,std::to_string(authorized));
-        case db_status::not_found:
-            return fail(std::move(request),http::status::not_found,msg);
-        case db_status::unauthorized:
-            return fail(std::move(request),http::status::unauthorized,msg);
-        default:
-            return fail(std::move(request),http::status::bad_request,msg);
-        }
+    const db_status& status_ {dbase_handler_.authz_check_get(user_uid,rp_ident,authorized,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::ok,std::to_string(authorized));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
     }
-    return fail(std::move(request),http::status::bad_request,"bad request");
 }
 
-http::response<http::string_body> http_handler::handle_authz_manage_post(http::request<http::string_body> &&request, const std::string &requester_id)
+http::response<http::string_body> http_handler::handle_authz_batch_post(http::request<http::string_body> &&request, const std::string &requester_id)
 {
-    const std::string& target {request.target()};
-    boost::regex re {"^/api/v1/u-auth/authz/manage/" + regex_uid_ + "/assign/" + regex_uid_ + "$"};
-    boost::smatch match;
-    if(boost::regex_match(target,match,re)){
-        std::string msg {};
-        const std::string& requested_user_id {match[1]};
-        const std::string& requested_rp_id {match[2]};
+    boost::ignore_unused(requester_id);
+    std::string msg {};
+    std::string decisions {};
+    const std::string& body {request.body()};
 
-        const db_status& status_ {dbase_handler_ptr_->authz_manage_post(requested_user_id,requested_rp_id,requester_id,msg)};
-        switch(status_){
-        case db_status::fail:
-            return fail(std::move(request),http::status::bad_request,msg);
-        case db_status::success:
-            return success(std::move(request),http::status::created,msg);
-        case db_status::not_found:
-            return fail(std::move(request),http::status::not_found,msg);
-        case db_status::unauthorized:
-            return fail(std::move(request),http::status::unauthorized,msg);
-        default:
-            return fail(std::move(request),http::status::bad_request,msg);
-        }
+    const db_status& status_ {dbase_handler_.authz_batch_check(body,decisions,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::ok,std::move(decisions));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
     }
-    return fail(std::move(request),http::status::bad_request,"bad request");
 }
 
-http::response<http::string_body> http_handler::handle_authz_manage_delete(http::request<http::string_body> &&request, const std::string &requester_id)
+http::response<http::string_body> http_handler::handle_authz_manage_post(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id)
 {
-    const std::string& target {request.target()};
-    boost::regex re {"^/api/v1/u-auth/authz/manage/" + regex_uid_ + "/revoke/" + regex_uid_ + "$"};
-    boost::smatch match;
-    if(boost::regex_match(target,match,re)){
-        std::string msg {};
-        const std::string& requested_user_id {match[1]};
-        const std::string& requested_rp_id {match[2]};
+    std::string msg {};
+    const std::string& requested_user_id {match.captures[0]};
+    const std::string& requested_rp_id {match.captures[1]};
 
-        const db_status& status_ {dbase_handler_ptr_->authz_manage_delete(requested_user_id,requested_rp_id,requester_id,msg)};
-        switch(status_){
-        case db_status::fail:
-            return fail(std::move(request),http::status::bad_request,msg);
-        case db_status::success:
-            return success(std::move(request),http::status::no_content,msg);
-        case db_status::not_found:
-            return fail(std::move(request),http::status::not_found,msg);
-        case db_status::unauthorized:
-            return fail(std::move(request),http::status::unauthorized,msg);
-        default:
-            return fail(std::move(request),http::status::bad_request,msg);
-        }
+    const db_status& status_ {dbase_handler_.authz_manage_post(requested_user_id,requested_rp_id,requester_id,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::created,std::move(msg));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
     }
-    return fail(std::move(request),http::status::bad_request,"bad request");
-}
-
-http::response<http::string_body> http_handler::handle_rp_get(http::request<http::string_body> &&request, const std::string &requester_id)
-{
-    const std::string& target {request.target()};
-    {//rps list
-        boost::regex re {"^/api/v1/u-auth/roles-permissions$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){
-            std::string msg {};
-            std::string rps {};
-            std::map<std::string,std::string> query_map {
-                {"limit","100"},
-                {"offset","0"}
-            };
-
-            const db_status& status_ {dbase_handler_ptr_->rp_list_get(rps,query_map,requester_id,msg)};
-            switch(status_){
-            case db_status::fail:
-                return fail(std::move(request),http::status::bad_request,msg);
-            case db_status::success:
-                return success(std::move(request),http::status::ok,rps);
-            case db_status::not_found:
-                return fail(std::move(request),http::status::not_found,msg);
-            case db_status::unauthorized:
-                return fail(std::move(request),http::status::unauthorized,msg);
-            default:
-                return fail(std::move(request),http::status::bad_request,msg);
-            }
-        }
+}
+
+http::response<http::string_body> http_handler::handle_authz_manage_delete(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id)
+{
+    std::string msg {};
+    const std::string& requested_user_id {match.captures[0]};
+    const std::string& requested_rp_id {match.captures[1]};
+
+    const db_status& status_ {dbase_handler_.authz_manage_delete(requested_user_id,requested_rp_id,requester_id,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::no_content,std::move(msg));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
     }
+}
 
-    {//rps by rp_uid
-        boost::regex re {"^/api/v1/u-auth/roles-permissions/" + regex_uid_ + "$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){
-            const std::string& rp_uid {match[1]};
-            std::string msg {};
-            std::string rp {};
-
-            const db_status& status_ {dbase_handler_ptr_->rp_info_get(rp_uid,rp,requester_id,msg)};
-            switch(status_){
-            case db_status::fail:
-                return fail(std::move(request),http::status::bad_request,msg);
-            case db_status::success:
-                return success(std::move(request),http::status::ok,rp);
-            case db_status::not_found:
-                return fail(std::move(request),http::status::not_found,msg);
-            case db_status::unauthorized:
-                return fail(std::move(request),http::status::unauthorized,msg);
-            default:
-                return fail(std::move(request),http::status::bad_request,msg);
-            }
-        }
+http::response<http::string_body> http_handler::handle_rps_list_get(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id, chunk_stream *stream_ptr)
+{
+    std::map<std::string,std::string> query_map {};
+    if(match.query.empty()){
+        query_map.emplace("limit","100");
+        query_map.emplace("offset","0");
+    }
+    else{
+        query_map_get(match.query,query_map);
     }
 
-    {//rps details
-        boost::regex re {"^/api/v1/u-auth/roles-permissions/" + regex_uid_ + "/detail$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){
-            const std::string& rp_uid {match[1]};
-            std::string msg {};
-            std::string rp_detail {};
-
-            const db_status& status_ {dbase_handler_ptr_->rp_rp_detail_get(rp_uid,rp_detail,requester_id,msg)};
-            switch(status_){
-            case db_status::fail:
-                return fail(std::move(request),http::status::bad_request,msg);
-            case db_status::success:
-                return success(std::move(request),http::status::ok,rp_detail);
-            case db_status::not_found:
-                return fail(std::move(request),http::status::not_found,msg);
-            case db_status::unauthorized:
-                return fail(std::move(request),http::status::unauthorized,msg);
-            default:
-                return fail(std::move(request),http::status::bad_request,msg);
-            }
-        }
+    std::string msg {};
+    std::string rps {};
+    const db_status& status_ {dbase_handler_.rp_list_get(rps,query_map,requester_id,stream_ptr,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::ok,std::move(rps));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
     }
+}
 
-    {//all users for rps by rp_uid
-        boost::regex re {"^/api/v1/u-auth/roles-permissions/" + regex_uid_ + "/associated-users$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){
-            const std::string& rp_uid {match[1]};
-            std::string msg {};
-            std::string users {};
-
-            const db_status& status_ {dbase_handler_ptr_->rp_user_get(rp_uid,users,requester_id,msg)};
-            switch(status_){
-            case db_status::fail:
-                return fail(std::move(request),http::status::bad_request,msg);
-            case db_status::success:
-                return success(std::move(request),http::status::ok,users);
-            case db_status::not_found:
-                return fail(std::move(request),http::status::not_found,msg);
-            case db_status::unauthorized:
-                return fail(std::move(request),http::status::unauthorized,msg);
-            default:
-                return fail(std::move(request),http::status::bad_request,msg);
-            }
-        }
+http::response<http::string_body> http_handler::handle_rp_get(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id)
+{
+    const std::string& rp_uid {match.captures[0]};
+    std::string msg {};
+    std::string rp {};
+
+    const db_status& status_ {dbase_handler_.rp_info_get(rp_uid,rp,requester_id,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::ok,std::move(rp));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
     }
+}
 
-    {//all users for rps by rp_uid with limit and/or offset
-        boost::regex re {"^/api/v1/u-auth/roles-permissions/" + regex_uid_ + "/associated-users" + regex_any_ + "$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){
-            const std::string& rp_uid {match[1]};
-            std::string limit {};
-            std::string offset {};
-            boost::url url_ {target};
-            auto query=url_.query();
-            if(!query.empty()){
-                boost::urls::result<boost::urls::params_encoded_view> result=boost::urls::parse_query(query);
-                if(!result.has_error()){
-                    const boost::urls::params_encoded_view& view {result.value()};
-                    if(view.contains("limit")){
-                        auto it {view.find("limit")};
-                        limit=std::string {it->value};
-                    }
-                    if(view.contains("offset")){
-                        auto it {view.find("offset")};
-                        offset=std::string {it->value};
-                    }
-                }
-            }
-            //check limit and offset
-            if(limit.empty() & offset.empty()){
-                 return fail(std::move(request),http::status::not_found,"not found");
-            }
-
-            std::string msg {};
-            std::string users {};
-
-            const db_status& status_ {dbase_handler_ptr_->rp_user_get(rp_uid,users,limit,offset,requester_id,msg)};
-            switch(status_){
-            case db_status::fail:
-                return fail(std::move(request),http::status::bad_request,msg);
-            case db_status::success:
-                return success(std::move(request),http::status::ok,users);
-            case db_status::not_found:
-                return fail(std::move(request),http::status::not_found,msg);
-            case db_status::unauthorized:
-                return fail(std::move(request),http::status::unauthorized,msg);
-            default:
-                return fail(std::move(request),http::status::bad_request,msg);
-            }
-        }
+http::response<http::string_body> http_handler::handle_rp_detail_get(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id)
+{
+    const std::string& rp_uid {match.captures[0]};
+    std::string msg {};
+    std::string rp_detail {};
+
+    const db_status& status_ {dbase_handler_.rp_rp_detail_get(rp_uid,rp_detail,requester_id,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::ok,std::move(rp_detail));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
     }
+}
 
-    {//rp list with limit and/or offset
-        boost::regex re {"^/api/v1/u-auth/roles-permissions" + regex_any_ + "$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){
-            std::map<std::string,std::string> query_map {};
-            std::size_t pos {target.find('?')};
-            if(pos!=std::string::npos){
-                ++pos;
-                const std::string& query {target.substr(pos,target.size()-pos)};
-                std::vector<std::string> query_items {};
-                boost::split(query_items,query,boost::is_any_of("&"));
-                for(const std::string& query_item: query_items){
-                    std::vector<std::string> query_item_split {};
-                    boost::split(query_item_split,query_item,boost::is_any_of("="));
-                    if(query_item_split.size()==2){
-                        query_map.emplace(query_item_split.at(0),query_item_split.at(1));
-                    }
-                }
-            }
-
-            std::string msg {};
-            std::string rps {};
-            const db_status& status_ {dbase_handler_ptr_->rp_list_get(rps,query_map,requester_id,msg)};
-            switch(status_){
-            case db_status::fail:
-                return fail(std::move(request),http::status::bad_request,msg);
-            case db_status::success:
-                return success(std::move(request),http::status::ok,rps);
-            case db_status::not_found:
-                return fail(std::move(request),http::status::not_found,msg);
-            case db_status::unauthorized:
-                return fail(std::move(request),http::status::unauthorized,msg);
-            default:
-                return fail(std::move(request),http::status::bad_request,msg);
-            }
+http::response<http::string_body> http_handler::handle_rp_users_get(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id, chunk_stream *stream_ptr)
+{
+    const std::string& rp_uid {match.captures[0]};
+    std::string msg {};
+    std::string users {};
+
+    db_status status_ {db_status::fail};
+    if(match.query.empty()){//all users for rps by rp_uid
+        status_=dbase_handler_.rp_user_get(rp_uid,users,requester_id,stream_ptr,msg);
+    }
+    else{//all users for rps by rp_uid with limit and/or offset
+        std::map<std::string,std::string> query_map {};
+        query_map_get(match.query,query_map);
+        //checked as for the list endpoints, postgres errors never reach the body; no limit returns all
+        int limit {0};
+        int offset {0};
+        if(!dbase_handler::paging_check(query_map,limit,offset,msg)){
+            return fail(std::move(request),http::status::bad_request,msg);
         }
+        status_=dbase_handler_.rp_user_get(rp_uid,users,limit,offset,requester_id,stream_ptr,msg);
     }
-    return fail(std::move(request),http::status::bad_request,"bad request");
-}
-
-http::response<http::string_body> http_handler::handle_rp_put(http::request<http::string_body> &&request, const std::string &requester_id)
-{
-    const std::string& target {request.target()};
-    {//update role_permission
-        boost::regex re {"^/api/v1/u-auth/roles-permissions/" + regex_uid_ + "$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){
-            std::string msg;
-            const std::string& rp_uid {match[1]};
-            const std::string& body {request.body()};
-
-            const db_status& status_ {dbase_handler_ptr_->rp_info_put(rp_uid,body,requester_id,msg)};
-            switch(status_){
-            case db_status::fail:
-                return fail(std::move(request),http::status::bad_request,msg);
-            case db_status::success:
-                return success(std::move(request),http::status::ok,msg);
-            case db_status::not_found:
-                return fail(std::move(request),http::status::not_found,msg);
-            case db_status::unauthorized:
-                return fail(std::move(request),http::status::unauthorized,msg);
-            default:
-                return fail(std::move(request),http::status::bad_request,msg);
-            }
-        }
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::ok,std::move(users));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
     }
-    {//add role_permission relationship
-        boost::regex re {"^/api/v1/u-auth/roles-permissions/" + regex_uid_ + "/add-child/" + regex_uid_ + "$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){
-            std::string msg;
-            const std::string& parent_uid {match[1]};
-            const std::string& child_uid {match[2]};
-
-            const db_status& status_ {dbase_handler_ptr_->rp_child_put(parent_uid,child_uid,requester_id,msg)};
-            switch(status_){
-            case db_status::fail:
-                return fail(std::move(request),http::status::bad_request,msg);
-            case db_status::success:
-                return success(std::move(request),http::status::ok,msg);
-            case db_status::not_found:
-                return fail(std::move(request),http::status::not_found,msg);
-            case db_status::unauthorized:
-                return fail(std::move(request),http::status::unauthorized,msg);
-            default:
-                return fail(std::move(request),http::status::bad_request,msg);
-            }
-        }
+}
+
+http::response<http::string_body> http_handler::handle_rp_put(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id)
+{
+    std::string msg;
+    const std::string& rp_uid {match.captures[0]};
+    const std::string& body {request.body()};
+
+    const db_status& status_ {dbase_handler_.rp_info_put(rp_uid,body,requester_id,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::ok,std::move(msg));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
+    }
+}
+
+http::response<http::string_body> http_handler::handle_rp_child_put(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id)
+{
+    std::string msg;
+    const std::string& parent_uid {match.captures[0]};
+    const std::string& child_uid {match.captures[1]};
+
+    const db_status& status_ {dbase_handler_.rp_child_put(parent_uid,child_uid,requester_id,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::ok,std::move(msg));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
     }
-    return fail(std::move(request),http::status::not_found,"not found");
 }
 
 http::response<http::string_body> http_handler::handle_rp_post(http::request<http::string_body> &&request, const std::string &requester_id)
@@ -651,12 +559,12 @@ http::response<http::string_body> http_handler::handle_rp_post(http::request<htt
     std::string msg;
     const std::string& body {request.body()};
 
-    const db_status& status_ {dbase_handler_ptr_->rp_info_post(body,requester_id,msg)};
+    const db_status& status_ {dbase_handler_.rp_info_post(body,requester_id,msg)};
     switch(status_){
     case db_status::fail:
         return fail(std::move(request),http::status::bad_request,msg);
     case db_status::success:
-        return success(std::move(request),http::status::created,msg);
+        return success(std::move(request),http::status::created,std::move(msg));
     case db_status::not_found:
         return fail(std::move(request),http::status::not_found,msg);
     case db_status::unauthorized:
@@ -668,189 +576,195 @@ http::response<http::string_body> http_handler::handle_rp_post(http::request<htt
     }
 }
 
-http::response<http::string_body> http_handler::handle_rp_delete(http::request<http::string_body> &&request, const std::string &requester_id)
-{
-    const std::string& target {request.target()};
-    {//remove role_permission
-        boost::regex re {"^/api/v1/u-auth/roles-permissions/" + regex_uid_ + "$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){
-            std::string msg;
-            const std::string& rp_uid {match[1]};
-
-            const db_status& status_ {dbase_handler_ptr_->rp_info_delete(rp_uid,requester_id,msg)};
-            switch(status_){
-            case db_status::fail:
-                return fail(std::move(request),http::status::bad_request,msg);
-            case db_status::success:
-                return success(std::move(request),http::status::no_content,msg);
-            case db_status::not_found:
-                return fail(std::move(request),http::status::not_found,msg);
-            case db_status::unauthorized:
-                return fail(std::move(request),http::status::unauthorized,msg);
-            case db_status::unprocessable_entity:
-                return fail(std::move(request),http::status::unprocessable_entity,msg);
-            default:
-                return fail(std::move(request),http::status::bad_request,msg);
-            }
-        }
+http::response<http::string_body> http_handler::handle_rp_delete(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id)
+{
+    std::string msg;
+    const std::string& rp_uid {match.captures[0]};
+
+    const db_status& status_ {dbase_handler_.rp_info_delete(rp_uid,requester_id,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::no_content,std::move(msg));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    case db_status::unprocessable_entity:
+        return fail(std::move(request),http::status::unprocessable_entity,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
+    }
+}
+
+http::response<http::string_body> http_handler::handle_rp_child_delete(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id)
+{
+    std::string msg;
+    const std::string& parent_uid {match.captures[0]};
+    const std::string& child_uid {match.captures[1]};
+
+    const db_status& status_ {dbase_handler_.rp_child_delete(parent_uid,child_uid,requester_id,msg)};
+    switch(status_){
+    case db_status::fail:
+        return fail(std::move(request),http::status::bad_request,msg);
+    case db_status::success:
+        return success(std::move(request),http::status::no_content,std::move(msg));
+    case db_status::not_found:
+        return fail(std::move(request),http::status::not_found,msg);
+    case db_status::unauthorized:
+        return fail(std::move(request),http::status::unauthorized,msg);
+    default:
+        return fail(std::move(request),http::status::bad_request,msg);
     }
-    {//remove role_permission relationship
-        boost::regex re {"^/api/v1/u-auth/roles-permissions/" + regex_uid_ + "/remove-child/" + regex_uid_ + "$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){
-            std::string msg;
-            const std::string& parent_uid {match[1]};
-            const std::string& child_uid {match[2]};
-
-            const db_status& status_ {dbase_handler_ptr_->rp_child_delete(parent_uid,child_uid,requester_id,msg)};
-            switch(status_){
-            case db_status::fail:
-                return fail(std::move(request),http::status::bad_request,msg);
-            case db_status::success:
-                return success(std::move(request),http::status::no_content,msg);
-            case db_status::not_found:
-                return fail(std::move(request),http::status::not_found,msg);
-            case db_status::unauthorized:
-                return fail(std::move(request),http::status::unauthorized,msg);
-            default:
-                return fail(std::move(request),http::status::bad_request,msg);
-            }
+}
+
+http::response<http::string_body> http_handler::handle_metrics_get(http::request<http::string_body> &&request, const std::string &requester_id)
+{
+    {//pool, executor and keystore internals are for UAuthAdmin only
+        std::string msg {};
+        bool authorized {false};
+        const std::string& rp_name {"UAuthAdmin"};
+
+        const db_status& status_ {dbase_handler_.authz_check_get(requester_id,rp_name,authorized,msg)};
+        boost::ignore_unused(status_);
+        if(!authorized){
+            return fail(std::move(request),http::status::unauthorized,"unauthorized");
         }
     }
-    return fail(std::move(request),http::status::not_found,"not found");
+    boost::json::object metrics {};
+    if(context_.dbase_executor_ptr){
+        metrics.emplace("dbase_executor",context_.dbase_executor_ptr->stats_get());
+    }
+    if(context_.crypto_executor_ptr){
+        metrics.emplace("crypto_executor",context_.crypto_executor_ptr->stats_get());
+    }
+    if(context_.dbase_pool_ptr){
+        metrics.emplace("dbase_pool",context_.dbase_pool_ptr->stats_get());
+    }
+    if(context_.authz_engine_ptr){
+        metrics.emplace("authz_engine",context_.authz_engine_ptr->stats_get());
+    }
+    if(context_.authz_cache_ptr){
+        metrics.emplace("authz_cache",context_.authz_cache_ptr->stats_get());
+    }
+    if(context_.x509_keystore_ptr){
+        metrics.emplace("x509_keystore",context_.x509_keystore_ptr->stats_get());
+    }
+    if(context_.x509_keypair_pool_ptr){
+        metrics.emplace("x509_keypair_pool",context_.x509_keypair_pool_ptr->stats_get());
+    }
+    return success(std::move(request),http::status::ok,boost::json::serialize(metrics));
 }
 
-http::response<http::string_body> http_handler::handle_certificate_post(http::request<http::string_body> &&request, const std::string &requester_id)
+http::response<http::string_body> http_handler::handle_certificate_user_post(http::request<http::string_body> &&request, const route_match &match, const std::string &requester_id)
 {
-    const std::string& target {request.target()};
-    {//handle user certificate
-        {//check if authorized
-            std::string msg {};
-            bool authorized {false};
-            const std::string& rp_name {"user_certificate"};
+    {//check if authorized
+        std::string msg {};
+        bool authorized {false};
+        const std::string& rp_name {"user_certificate"};
 
-            const db_status& status_ {dbase_handler_ptr_->authz_check_get(requester_id,rp_name,authorized,msg)};
-            boost::ignore_unused(status_);
-            if(!authorized){
-                return fail(std::move(request),http::status::unauthorized,"unauthorized");
-            }
+        const db_status& status_ {dbase_handler_.authz_check_get(requester_id,rp_name,authorized,msg)};
+        boost::ignore_unused(status_);
+        if(!authorized){
+            return fail(std::move(request),http::status::unauthorized,"unauthorized");
         }
-        boost::regex re {"^/api/v1/u-auth/certificates/user/" + regex_uid_ + "?" + regex_any_ + "$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){//get fields from target
-            const std::string& user_id {match[1]};
-            std::string pkcs_pass {};
-
-            boost::url url_ {target};
-            auto query=url_.query();
-            if(!query.empty()){//check query
-                boost::urls::result<boost::urls::params_encoded_view> result=boost::urls::parse_query(query);
-                if(!result.has_error()){
-                    const boost::urls::params_encoded_view& view {result.value()};
-                    if(view.contains("certificate_password")){
-                        auto it {view.find("certificate_password")};
-                        pkcs_pass=std::string {it->value};
-                    }
-                    else{
-                        return fail(std::move(request),http::status::bad_request,"bad request");
-                    }
-                }
-            }
-
-            std::string user_email {};
-            {//check user by user_id and get user email
-                std::string msg {};
-                std::string user {};
-                const db_status& status_ {dbase_handler_ptr_->user_info_get(user_id,user,requester_id,msg)};
-                if(status_!=db_status::success){
-                    return fail(std::move(request),http::status::not_found,msg);
-                }
-
-                boost::system::error_code ec;
-                const boost::json::value& v {boost::json::parse(user,ec)};
-                if(ec || !v.is_object()){
-                    return fail(std::move(request),http::status::not_found,"not valid user");
-                }
-                const boost::json::object& user_obj {v.as_object()};
-                user_email=user_obj.at("email").as_string().c_str();
-            }
-
-            const std::string& pkcs_name {"pkcs"};
-            const std::string& root_path {params_.at("UA_CA_CRT_PATH").as_string().c_str()};
-            const std::string& pub_path  {params_.at("UA_SIGNING_CA_CRT_PATH").as_string().c_str()};
-            const std::string& pr_path   {params_.at("UA_SIGNING_CA_KEY_PATH").as_string().c_str()};
-            const std::string& pr_pass   {params_.at("UA_SIGNING_CA_KEY_PASS").as_string().c_str()};
-
-            std::string msg {};
-            std::vector<char> PKCS12_content {};
-            std::shared_ptr<x509_generator> x509 {new x509_generator(logger_ptr_)};
-            const bool& ok {x509->create_PKCS12(user_id,root_path,pub_path,pr_path,pr_pass,pkcs_pass,pkcs_name,PKCS12_content,msg)};
-            if(ok){
-                std::string body {PKCS12_content.begin(),PKCS12_content.end()};
-                body_ptr_.reset(new std::string {body});
-                http::response<http::string_body> response {http::status::ok,request.version()};
-                response.keep_alive(request.keep_alive());
-                response.set(http::field::server, BOOST_BEAST_VERSION_STRING);
-                response.set(http::field::content_type,"application/x-pkcs12");
-                response.set(http::field::content_length,std::to_string(body_ptr_->size()));
-                response.set(http::field::content_disposition,"attachment;filename=" + user_email + ".pfx");
-                response.body()=*body_ptr_;
-                response.prepare_payload();
-                return response;
-            }
-            return fail(std::move(request),http::status::bad_request,msg);
+    }
+    const std::string& user_id {match.captures[0]};
+    std::string pkcs_pass {};
+    if(!match.query.empty()){//check query
+        std::map<std::string,std::string> query_map {};
+        query_map_get(match.query,query_map);
+        const auto& it {query_map.find("certificate_password")};
+        if(it==query_map.end()){
+            return fail(std::move(request),http::status::bad_request,"bad request");
         }
+        pkcs_pass=it->second;
     }
-    {//handle agent certificate
-        {//check if authorized
-            std::string msg {};
-            bool authorized {false};
-            const std::string& rp_name {"agent_certificate"};
-
-            const db_status& status_ {dbase_handler_ptr_->authz_check_get(requester_id,rp_name,authorized,msg)};
-            boost::ignore_unused(status_);
-            if(!authorized){
-                return fail(std::move(request),http::status::unauthorized,"unauthorized");
-            }
+
+    std::string user_email {};
+    {//check user by user_id and get user email
+        std::string msg {};
+        std::string user {};
+        const db_status& status_ {dbase_handler_.user_info_get(user_id,user,requester_id,msg)};
+        if(status_!=db_status::success){
+            return fail(std::move(request),http::status::not_found,msg);
         }
-        boost::regex re {"^/api/v1/u-auth/certificates/agent/sign-csr$"};
-        boost::smatch match;
-        if(boost::regex_match(target,match,re)){
-            const std::string& content {request.body()};
-            const std::vector<char>& x509_REQ_content {content.begin(),content.end()};
-            const std::string& pub_path {params_.at("UA_SIGNING_CA_CRT_PATH").as_string().c_str()};
-            const std::string& pr_path  {params_.at("UA_SIGNING_CA_KEY_PATH").as_string().c_str()};
-            const std::string& pr_pass  {params_.at("UA_SIGNING_CA_KEY_PASS").as_string().c_str()};
-
-            std::string msg {};
-            std::vector<char> x509_content {};
-            std::shared_ptr<x509_generator> x509 {new x509_generator(logger_ptr_)};
-            const bool& ok {x509->create_X509(pub_path,pr_path,pr_pass,x509_REQ_content,x509_content,msg)};
-            if(ok){
-                std::string body {x509_content.begin(),x509_content.end()};
-                body_ptr_.reset(new std::string {body});
-                http::response<http::string_body> response {http::status::created,request.version()};
-                response.keep_alive(request.keep_alive());
-                response.set(http::field::server, BOOST_BEAST_VERSION_STRING);
-                response.set(http::field::content_type,"application/pem-certificate-chain");
-                response.set(http::field::content_length,std::to_string(body_ptr_->size()));
-                response.set(http::field::content_disposition,"attachment;filename=agent_certificate.pem");
-                response.body()=*body_ptr_;
-                response.prepare_payload();
-                return response;
-            }
-            return fail(std::move(request),http::status::bad_request,msg);
+
+        boost::system::error_code ec;
+        const boost::json::value& v {boost::json::parse(user,ec)};
+        if(ec || !v.is_object()){
+            return fail(std::move(request),http::status::not_found,"not valid user");
         }
-    }
-    return fail(std::move(request),http::status::not_found,"not found");
+        const boost::json::object& user_obj {v.as_object()};
+        user_email=user_obj.at("email").as_string().c_str();
+    }
+
+    const std::string& pkcs_name {"pkcs"};
+    const std::shared_ptr<const x509_material>& material {context_.x509_keystore_ptr ? context_.x509_keystore_ptr->material_get() : nullptr};
+    if(!material){
+        return fail(std::move(request),http::status::service_unavailable,"CA material not loaded");
+    }
+
+    std::string msg {};
+    const std::shared_ptr<EVP_PKEY>& user_key {context_.x509_keypair_pool_ptr->keypair_get(msg)};
+    if(!user_key){
+        return fail(std::move(request),http::status::internal_server_error,msg);
+    }
+    std::string PKCS12_content {};
+    x509_generator x509 {context_.logger_ptr};
+    const bool& ok {x509.create_PKCS12(user_id,*material,user_key.get(),context_.pkcs12,pkcs_pass,pkcs_name,PKCS12_content,msg)};
+    if(ok){
+        http::response<http::string_body> response {http::status::ok,request.version()};
+        response.keep_alive(request.keep_alive());
+        response.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+        response.set(http::field::content_type,"application/x-pkcs12");
+        response.set(http::field::content_disposition,"attachment;filename=" + user_email + ".pfx");
+        response.body()=std::move(PKCS12_content);
+        response.prepare_payload();
+        return response;
+    }
+    return fail(std::move(request),http::status::bad_request,msg);
 }
 
-http_handler::http_handler(const boost::json::object &params, uc_status status, std::shared_ptr<spdlog::logger> logger_ptr)
-    :params_{params},status_{status},logger_ptr_{logger_ptr}
+http::response<http::string_body> http_handler::handle_certificate_agent_post(http::request<http::string_body> &&request, const std::string &requester_id)
 {
-    {//init dbase_handler
-        dbase_handler_ptr_.reset(new dbase_handler{params_,logger_ptr});
+    {//check if authorized
+        std::string msg {};
+        bool authorized {false};
+        const std::string& rp_name {"agent_certificate"};
+
+        const db_status& status_ {dbase_handler_.authz_check_get(requester_id,rp_name,authorized,msg)};
+        boost::ignore_unused(status_);
+        if(!authorized){
+            return fail(std::move(request),http::status::unauthorized,"unauthorized");
+        }
     }
+    const std::string& x509_REQ_content {request.body()};
+    const std::shared_ptr<const x509_material>& material {context_.x509_keystore_ptr ? context_.x509_keystore_ptr->material_get() : nullptr};
+    if(!material){
+        return fail(std::move(request),http::status::service_unavailable,"CA material not loaded");
+    }
+
+    std::string msg {};
+    std::string x509_content {};
+    x509_generator x509 {context_.logger_ptr};
+    const bool& ok {x509.create_X509(*material,x509_REQ_content,x509_content,msg)};
+    if(ok){
+        http::response<http::string_body> response {http::status::created,request.version()};
+        response.keep_alive(request.keep_alive());
+        response.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+        response.set(http::field::content_type,"application/pem-certificate-chain");
+        response.set(http::field::content_disposition,"attachment;filename=agent_certificate.pem");
+        response.body()=std::move(x509_content);
+        response.prepare_payload();
+        return response;
+    }
+    return fail(std::move(request),http::status::bad_request,msg);
+}
+
+http_handler::http_handler(const server_context &context)
+    :context_{context},dbase_handler_{context_}
+{
 }
 
@@ -2,8 +2,12 @@
 #define HTTP_HANDLER_H
 #include "defines.h"
 #include "dbase/dbase_handler.h"
+#include "http_router.h"
+#include "server_context.h"
+#include "chunk_stream.h"
 
 #include <map>
+#include <atomic>
 #include <string>
 #include <memory>
 #include <functional>
@@ -20,62 +24,86 @@
 namespace spdlog{
     class logger;
 }
+class task_executor;
+class dbase_pool;
+class authz_engine;
 
 using namespace boost::beast;
 
 class http_handler
 {
 private:
-    uc_status status_ {uc_status::fail};
-    const std::string regex_any_ {"([\\s\\S]*)"};
-    const std::string regex_uid_ {"([0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{12})"};
-    boost::json::object params_ {};
-
-    //error handlers
-    http::response<http::string_body> fail(http::request<http::string_body>&& request,http::status code,const std::string& body);
-    http::response<http::string_body> success(http::request<http::string_body>&& request, http::status code, const std::string& body);
-
-    //rote handlers
-    http::response<http::string_body> handle_user(http::request<http::string_body>&& request,const std::string& requester_id);
-    http::response<http::string_body> handle_authz(http::request<http::string_body>&& request,const std::string& requester_id);
-    http::response<http::string_body> handle_authz_manage(http::request<http::string_body>&& request,const std::string& requester_id);
-    http::response<http::string_body> handle_rp(http::request<http::string_body>&& request,const std::string& requester_id);
-    http::response<http::string_body> handle_certificate(http::request<http::string_body>&& request,const std::string& requester_id);
-
-    //user verb handlers
-    http::response<http::string_body> handle_user_get(http::request<http::string_body>&& request,const std::string& requester_id);
-    http::response<http::string_body> handle_user_put(http::request<http::string_body>&& request,const std::string& requester_id);
+    //owned by session, outlives handler
+    const server_context& context_;
+    //built once, shared by all sessions
+    static const http_router router_;
+
+    //error handlers, body is moved into the response
+    http::response<http::string_body> fail(http::request<http::string_body>&& request,http::status code,std::string body);
+    http::response<http::string_body> success(http::request<http::string_body>&& request, http::status code, std::string body);
+
+    //split query on '&' and first '=', values stay percent-encoded
+    static void query_map_get(boost::beast::string_view query,std::map<std::string,std::string>& query_map);
+
+    //route dispatch
+    //stream_ptr is set for routes accepted by is_streamed
+    http::response<http::string_body> handle_route(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id,chunk_stream* stream_ptr);
+
+    //user route handlers
+    http::response<http::string_body> handle_users_list_get(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id,chunk_stream* stream_ptr);
+    http::response<http::string_body> handle_user_get(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id);
+    http::response<http::string_body> handle_user_rps_get(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id);
+    //ETag is the set version, matching If-None-Match answers 304 without body
+    http::response<http::string_body> handle_user_effective_get(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id);
+    http::response<http::string_body> handle_user_put(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id);
     http::response<http::string_body> handle_user_post(http::request<http::string_body>&& request,const std::string& requester_id);
-    http::response<http::string_body> handle_user_delete(http::request<http::string_body>&& request,const std::string& requester_id);
-
-    //authz verb handlers
-    http::response<http::string_body> handle_authz_get(http::request<http::string_body>&& request,const std::string& requester_id);
-
-    //authz-manage verb handlers
-    http::response<http::string_body> handle_authz_manage_post(http::request<http::string_body>&& request,const std::string& requester_id);
-    http::response<http::string_body> handle_authz_manage_delete(http::request<http::string_body>&& request,const std::string& requester_id);
-
-    //rp verb handlers
-    http::response<http::string_body> handle_rp_get(http::request<http::string_body>&& request,const std::string& requester_id);
-    http::response<http::string_body> handle_rp_put(http::request<http::string_body>&& request,const std::string& requester_id);
+    http::response<http::string_body> handle_user_delete(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id);
+
+    //authz route handlers
+    http::response<http::string_body> handle_authz_get(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id);
+    http::response<http::string_body> handle_authz_batch_post(http::request<http::string_body>&& request,const std::string& requester_id);
+
+    //authz-manage route handlers
+    http::response<http::string_body> handle_authz_manage_post(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id);
+    http::response<http::string_body> handle_authz_manage_delete(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id);
+
+    //rp route handlers
+    http::response<http::string_body> handle_rps_list_get(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id,chunk_stream* stream_ptr);
+    http::response<http::string_body> handle_rp_get(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id);
+    http::response<http::string_body> handle_rp_detail_get(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id);
+    http::response<http::string_body> handle_rp_users_get(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id,chunk_stream* stream_ptr);
+    http::response<http::string_body> handle_rp_put(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id);
+    http::response<http::string_body> handle_rp_child_put(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id);
     http::response<http::string_body> handle_rp_post(http::request<http::string_body>&& request,const std::string& requester_id);
-    http::response<http::string_body> handle_rp_delete(http::request<http::string_body>&& request,const std::string& requester_id);
+    http::response<http::string_body> handle_rp_delete(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id);
+    http::response<http::string_body> handle_rp_child_delete(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id);
 
-    //certificate verb handler
-    http::response<http::string_body> handle_certificate_post(http::request<http::string_body>&& request,const std::string& requester_id);
+    //certificate route handlers
+    http::response<http::string_body> handle_certificate_user_post(http::request<http::string_body>&& request,const route_match& match,const std::string& requester_id);
+    http::response<http::string_body> handle_certificate_agent_post(http::request<http::string_body>&& request,const std::string& requester_id);
 
-    std::shared_ptr<std::string> body_ptr_ {nullptr};
-    std::shared_ptr<dbase_handler> dbase_handler_ptr_ {nullptr};
-    std::shared_ptr<spdlog::logger> logger_ptr_ {nullptr};
+    //metrics verb handler
+    http::response<http::string_body> handle_metrics_get(http::request<http::string_body>&& request,const std::string& requester_id);
+
+    dbase_handler dbase_handler_;
 
 public:
-    explicit http_handler(const boost::json::object& params,uc_status status,std::shared_ptr<spdlog::logger> logger_ptr);
+    explicit http_handler(const server_context& context);
     ~http_handler()=default;
 
+    //503 with Retry-After, used when the dbase or crypto executor queue is full
+    http::message_generator handle_unavailable(http::request<http::string_body>&& request);
+    //500 for a request whose handler threw, keeps the connection usable
+    http::message_generator handle_internal_error(http::request<http::string_body>&& request);
+    //certificate route, handled on the crypto executor
+    bool is_crypto(const http::request<http::string_body>& request) const;
+    //GET list route from HTTP/1.1 client, body can be written as chunks
+    bool is_streamed(const http::request<http::string_body>& request) const;
+
     template <class Body, class Allocator>
-    http::message_generator handle_request(http::request<Body, http::basic_fields<Allocator>>&& request){
+    http::message_generator handle_request(http::request<Body, http::basic_fields<Allocator>>&& request,chunk_stream* stream_ptr){
         {//handle uc_status
-            switch(status_){
+            switch(context_.status_ptr->load()){
             case uc_status::fail:
                 return fail(std::move(request),http::status::bad_request,"bad_request");
             case uc_status::success:
@@ -88,7 +116,6 @@ public:
         }
         std::string msg {};
         std::string requester_id {};
-        const std::string& target {request.target()};
 
         {//check headers and get requester_id
             const auto& headers {request.base()};
@@ -98,63 +125,44 @@ public:
             }
             requester_id=it->value();
         }
+        //views into request target, valid while request lives
+        const route_match& match {router_.route_find(request.method(),request.target())};
+        {//handle unknown route and metrics, no database init required
+            switch(match.id){
+            case route_id::not_found:
+                return fail(std::move(request),http::status::not_found,"not found");
+            case route_id::metrics_get:
+                return handle_metrics_get(std::move(request),requester_id);
+            default:
+                break;
+            }
+        }
 
         {//check and init database
-            const bool& db_ok {dbase_handler_ptr_->init_database(msg)};
+            const bool& db_ok {dbase_handler_.init_database(msg)};
             if(!db_ok){
                 return fail(std::move(request),http::status::internal_server_error,msg);
             }
         }
         {//log request
-            if(logger_ptr_){
+            if(context_.logger_ptr){
                 const std::string& body {request.body()};
                 const std::string& msg {(boost::format("method: %s, target: %s, body: %s")
                                                        % request.method_string()
                                                        % request.target()
                                                        % body).str()};
-                logger_ptr_->debug("request log, {}",msg);
-            }
-        }
-        http::response<http::string_body> response {fail(std::move(request),http::status::not_found,"not found")};
-        {//handle user
-            if(boost::starts_with(target,"/api/v1/u-auth/users")){
-                response=handle_user(std::move(request),requester_id);
-                goto log;
-            }
-        }
-        {//handle authz-manage
-            if(boost::starts_with(target,"/api/v1/u-auth/authz/manage")){
-                response=handle_authz_manage(std::move(request),requester_id);
-                goto log;
-            }
-        }
-        {//handle authz
-            if(boost::starts_with(target,"/api/v1/u-auth/authz")){
-                response=handle_authz(std::move(request),requester_id);
-                goto log;
-            }
-        }
-        {//handle rp
-            if(boost::starts_with(target,"/api/v1/u-auth/roles-permissions")){
-                response=handle_rp(std::move(request),requester_id);
-                goto log;
-            }
-        }
-        {//handle certificate
-            if(boost::starts_with(target,"/api/v1/u-auth/certificates")){
-                response=handle_certificate_post(std::move(request),requester_id);
-                goto log;
+                context_.logger_ptr->debug("request log, {}",msg);
             }
         }
-        log:
+        http::response<http::string_body> response {handle_route(std::move(request),match,requester_id,stream_ptr)};
         {//log response
-            if(logger_ptr_){
+            if(context_.logger_ptr){
                 const unsigned int& code {response.result_int()};
                 const std::string& body {response.body()};
                 const std::string& msg {(boost::format("status: %d, body: %s")
                                         % code
                                         % body).str()};
-                logger_ptr_->debug("response log, {}",msg);
+                context_.logger_ptr->debug("response log, {}",msg);
             }
         }
         return response;
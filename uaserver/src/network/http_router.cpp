@@ -0,0 +1,173 @@
+#include "http_router.h"
+
+namespace http=boost::beast::http;
+
+std::size_t http_router::verb_index(http::verb verb)
+{
+    switch(verb){
+    case http::verb::get:
+        return 0;
+    case http::verb::put:
+        return 1;
+    case http::verb::post:
+        return 2;
+    case http::verb::delete_:
+        return 3;
+    default:
+        return npos;
+    }
+}
+
+bool http_router::is_uid(boost::beast::string_view segment)
+{
+    //8-4-4-4-12 lowercase hex
+    if(segment.size()!=36){
+        return false;
+    }
+    for(std::size_t i=0;i<segment.size();++i){
+        const char& c {segment[i]};
+        if(i==8 || i==13 || i==18 || i==23){
+            if(c!='-'){
+                return false;
+            }
+        }
+        else if(!((c>='0' && c<='9') || (c>='a' && c<='f'))){
+            return false;
+        }
+    }
+    return true;
+}
+
+void http_router::route_add(http::verb verb, const std::string &pattern, route_id id)
+{
+    std::size_t node {0};
+    std::size_t begin {1};
+    while(begin<=pattern.size()){
+        std::size_t end {pattern.find('/',begin)};
+        if(end==std::string::npos){
+            end=pattern.size();
+        }
+        const std::string& segment {pattern.substr(begin,end-begin)};
+        std::size_t next {npos};
+        if(segment=="{uid}" || segment=="{name}"){
+            std::size_t& child {segment=="{uid}" ? nodes_[node].uid_child : nodes_[node].name_child};
+            if(child==npos){
+                child=nodes_.size();
+                nodes_.emplace_back();
+            }
+            next=child;
+        }
+        else{
+            for(const auto& literal:nodes_[node].literals){
+                if(literal.first==segment){
+                    next=literal.second;
+                    break;
+                }
+            }
+            if(next==npos){
+                next=nodes_.size();
+                nodes_[node].literals.emplace_back(segment,next);
+                nodes_.emplace_back();
+            }
+        }
+        node=next;
+        begin=end+1;
+    }
+    nodes_[node].routes[verb_index(verb)]=id;
+}
+
+http_router::http_router()
+{
+    nodes_.emplace_back();
+
+    const std::string& base {"/api/v1/u-auth"};
+    route_add(http::verb::get,base+"/metrics",route_id::metrics_get);
+
+    route_add(http::verb::get,base+"/users",route_id::users_list_get);
+    route_add(http::verb::get,base+"/users/{uid}",route_id::user_get);
+    route_add(http::verb::get,base+"/users/{uid}/roles-permissions",route_id::user_rps_get);
+    route_add(http::verb::get,base+"/users/{uid}/effective-permissions",route_id::user_effective_get);
+    route_add(http::verb::put,base+"/users/{uid}",route_id::user_put);
+    route_add(http::verb::post,base+"/users",route_id::user_post);
+    route_add(http::verb::delete_,base+"/users/{uid}",route_id::user_delete);
+
+    route_add(http::verb::get,base+"/authz/{uid}/authorized-to/{name}",route_id::authz_get);
+    route_add(http::verb::post,base+"/authz/batch",route_id::authz_batch_post);
+    route_add(http::verb::post,base+"/authz/manage/{uid}/assign/{uid}",route_id::authz_manage_post);
+    route_add(http::verb::delete_,base+"/authz/manage/{uid}/revoke/{uid}",route_id::authz_manage_delete);
+
+    route_add(http::verb::get,base+"/roles-permissions",route_id::rps_list_get);
+    route_add(http::verb::get,base+"/roles-permissions/{uid}",route_id::rp_get);
+    route_add(http::verb::get,base+"/roles-permissions/{uid}/detail",route_id::rp_detail_get);
+    route_add(http::verb::get,base+"/roles-permissions/{uid}/associated-users",route_id::rp_users_get);
+    route_add(http::verb::put,base+"/roles-permissions/{uid}",route_id::rp_put);
+    route_add(http::verb::put,base+"/roles-permissions/{uid}/add-child/{uid}",route_id::rp_child_put);
+    route_add(http::verb::post,base+"/roles-permissions",route_id::rp_post);
+    route_add(http::verb::delete_,base+"/roles-permissions/{uid}",route_id::rp_delete);
+    route_add(http::verb::delete_,base+"/roles-permissions/{uid}/remove-child/{uid}",route_id::rp_child_delete);
+
+    route_add(http::verb::post,base+"/certificates/user/{uid}",route_id::certificate_user_post);
+    route_add(http::verb::post,base+"/certificates/agent/sign-csr",route_id::certificate_agent_post);
+}
+
+route_match http_router::route_find(http::verb verb, boost::beast::string_view target) const
+{
+    route_match match {};
+    const std::size_t& verb_slot {verb_index(verb)};
+    if(verb_slot==npos || target.empty() || target.front()!='/'){
+        return match;
+    }
+
+    boost::beast::string_view path {target};
+    {//split query
+        const std::size_t& question {target.find('?')};
+        if(question!=boost::beast::string_view::npos){
+            path=target.substr(0,question);
+            match.query=target.substr(question+1);
+        }
+    }
+
+    std::size_t node {0};
+    std::size_t begin {1};
+    while(begin<=path.size()){
+        std::size_t end {path.find('/',begin)};
+        if(end==boost::beast::string_view::npos){
+            end=path.size();
+        }
+        const boost::beast::string_view& segment {path.substr(begin,end-begin)};
+        if(segment.empty()){
+            return route_match {};
+        }
+        const route_node& current {nodes_[node]};
+        std::size_t next {npos};
+        for(const auto& literal:current.literals){
+            if(segment==literal.first){
+                next=literal.second;
+                break;
+            }
+        }
+        if(next==npos){
+            if(current.uid_child!=npos && is_uid(segment)){
+                next=current.uid_child;
+            }
+            else if(current.name_child!=npos){
+                next=current.name_child;
+            }
+            else{
+                return route_match {};
+            }
+            if(match.captures_count==match.captures.size()){
+                return route_match {};
+            }
+            match.captures[match.captures_count++]=segment;
+        }
+        node=next;
+        begin=end+1;
+    }
+
+    match.id=nodes_[node].routes[verb_slot];
+    if(match.id==route_id::not_found){
+        return route_match {};
+    }
+    return match;
+}
@@ -0,0 +1,78 @@
+#ifndef HTTP_ROUTER_H
+#define HTTP_ROUTER_H
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <boost/beast/http.hpp>
+#include <boost/beast/core/string.hpp>
+
+enum class route_id{
+    not_found,
+    metrics_get,
+    users_list_get,
+    user_get,
+    user_rps_get,
+    user_effective_get,
+    user_put,
+    user_post,
+    user_delete,
+    authz_get,
+    authz_batch_post,
+    authz_manage_post,
+    authz_manage_delete,
+    rps_list_get,
+    rp_get,
+    rp_detail_get,
+    rp_users_get,
+    rp_put,
+    rp_child_put,
+    rp_post,
+    rp_delete,
+    rp_child_delete,
+    certificate_user_post,
+    certificate_agent_post
+};
+
+//Result of route lookup, views point into the request target
+struct route_match
+{
+    route_id id {route_id::not_found};
+    std::array<boost::beast::string_view,2> captures {};
+    std::size_t captures_count {0};
+    boost::beast::string_view query {};
+};
+
+//Segment trie built once, literal segments first, then {uid} and {name} captures
+class http_router
+{
+private:
+    static const std::size_t npos {static_cast<std::size_t>(-1)};
+    static const std::size_t verbs_count {4};
+
+    struct route_node{
+        std::vector<std::pair<std::string,std::size_t>> literals {};
+        std::size_t uid_child {npos};
+        std::size_t name_child {npos};
+        std::array<route_id,verbs_count> routes {{route_id::not_found,route_id::not_found,route_id::not_found,route_id::not_found}};
+    };
+    std::vector<route_node> nodes_ {};
+
+    static std::size_t verb_index(boost::beast::http::verb verb);
+    //Pattern segments: literal, "{uid}" or "{name}"
+    void route_add(boost::beast::http::verb verb,const std::string& pattern,route_id id);
+
+public:
+    explicit http_router();
+    ~http_router()=default;
+
+    //8-4-4-4-12 lowercase hex, the form accepted for {uid} segments
+    static bool is_uid(boost::beast::string_view segment);
+
+    //One pass over target, no allocations
+    route_match route_find(boost::beast::http::verb verb,boost::beast::string_view target) const;
+};
+
+#endif // HTTP_ROUTER_H
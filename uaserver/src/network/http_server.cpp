@@ -1,10 +1,92 @@
 #include "http_server.h"
 #include "http_session.h"
+#include "server_context.h"
+#include "io_shards.h"
 #include "settings/app_settings.h"
+#include "x509/x509_generator.h"
 
+#include <thread>
+#include <algorithm>
+#include <boost/predef/os.h>
 #include "spdlog/spdlog.h"
 
-void http_server::on_accept(boost::beast::error_code ec, boost::asio::ip::tcp::socket socket)
+#if BOOST_OS_LINUX
+typedef boost::asio::detail::socket_option::boolean<SOL_SOCKET,SO_REUSEPORT> reuse_port;
+#endif
+
+bool http_server::acceptor_open(boost::asio::ip::tcp::acceptor &acceptor, const boost::asio::ip::tcp::endpoint &ep, bool reuse_port_on)
+{
+    boost::beast::error_code ec;
+    acceptor.open(ep.protocol(),ec);
+    if(ec){
+        if(logger_ptr_){
+            logger_ptr_->critical("{}, error message: {}",
+                BOOST_CURRENT_FUNCTION,ec.message());
+        }
+        return false;
+    }
+
+    acceptor.set_option(boost::asio::socket_base::reuse_address(true), ec);
+    if(ec)
+    {
+        if(logger_ptr_){
+            logger_ptr_->critical("{}, error message: {}",
+                BOOST_CURRENT_FUNCTION,ec.message());
+        }
+        return false;
+    }
+
+#if BOOST_OS_LINUX
+    //kernel balances new connections across acceptors bound to the same port
+    if(reuse_port_on){
+        acceptor.set_option(reuse_port(true), ec);
+        if(ec)
+        {
+            if(logger_ptr_){
+                logger_ptr_->critical("{}, error message: {}",
+                    BOOST_CURRENT_FUNCTION,ec.message());
+            }
+            return false;
+        }
+    }
+#else
+    boost::ignore_unused(reuse_port_on);
+#endif
+
+    //bind to the server address
+    acceptor.bind(ep, ec);
+    if(ec){
+        if(logger_ptr_){
+            logger_ptr_->critical("{}, error message: {}",
+                BOOST_CURRENT_FUNCTION,ec.message());
+        }
+        return false;
+    }
+
+    //start listening for connections
+    acceptor.listen(boost::asio::socket_base::max_listen_connections, ec);
+    if(ec){
+        if(logger_ptr_){
+            logger_ptr_->critical("{}, error message: {}",
+                BOOST_CURRENT_FUNCTION,ec.message());
+        }
+        return false;
+    }
+    return true;
+}
+
+void http_server::do_accept(std::size_t index)
+{
+    if(io_shards_ptr_){//shard context has one thread, no strand needed
+        acceptors_.at(index)->async_accept(io_shards_ptr_->shard_get(index),
+            boost::beast::bind_front_handler(&http_server::on_accept,shared_from_this(),index));
+        return;
+    }
+    acceptors_.at(index)->async_accept(boost::asio::make_strand(io_),
+        boost::beast::bind_front_handler(&http_server::on_accept,shared_from_this(),index));
+}
+
+void http_server::on_accept(std::size_t index, boost::beast::error_code ec, boost::asio::ip::tcp::socket socket)
 {
     if(ec!=boost::beast::errc::operation_canceled){
         if(logger_ptr_){
@@ -12,45 +94,28 @@ void http_server::on_accept(boost::beast::error_code ec, boost::asio::ip::tcp::s
                                BOOST_CURRENT_FUNCTION);
         }
 
-        const std::string& UA_DB_NAME {app_settings_ptr_->value_get("UA_DB_NAME")};
-        const std::string& UA_DB_HOST {app_settings_ptr_->value_get("UA_DB_HOST")};
-        const std::string& UA_DB_PORT {app_settings_ptr_->value_get("UA_DB_PORT")};
-        const std::string& UA_DB_USER {app_settings_ptr_->value_get("UA_DB_USER")};
-        const std::string& UA_DB_PASS {app_settings_ptr_->value_get("UA_DB_PASS")};
-
-        const std::string& UA_CA_CRT_PATH {app_settings_ptr_->value_get("UA_CA_CRT_PATH")};
-        const std::string& UA_SIGNING_CA_CRT_PATH {app_settings_ptr_->value_get("UA_SIGNING_CA_CRT_PATH")};
-        const std::string& UA_SIGNING_CA_KEY_PATH {app_settings_ptr_->value_get("UA_SIGNING_CA_KEY_PATH")};
-        const std::string& UA_SIGNING_CA_KEY_PASS {app_settings_ptr_->value_get("UA_SIGNING_CA_KEY_PASS")};
-
-        if(UA_DB_NAME.empty() || UA_DB_HOST.empty() || UA_DB_PORT.empty() || UA_DB_USER.empty() || UA_DB_PASS.empty()){
-            if(logger_ptr_){
-               logger_ptr_->critical("{}, db params not defined in app_settings!",
-                   BOOST_CURRENT_FUNCTION);
-           }
+        if(io_shards_ptr_){//session block comes from the accepting shard and goes back to it
+            std::allocate_shared<http_session>(shard_allocator<http_session> {io_shards_ptr_->arena_get(index)},
+                                               std::move(socket),context_ptr_)->session_run();
         }
         else{
-            const boost::json::object& params {
-                {"UA_DB_NAME",UA_DB_NAME},
-                {"UA_DB_HOST",UA_DB_HOST},
-                {"UA_DB_PORT",UA_DB_PORT},
-                {"UA_DB_USER",UA_DB_USER},
-                {"UA_DB_PASS",UA_DB_PASS},
-
-                {"UA_CA_CRT_PATH",UA_CA_CRT_PATH},
-                {"UA_SIGNING_CA_CRT_PATH",UA_SIGNING_CA_CRT_PATH},
-                {"UA_SIGNING_CA_KEY_PATH",UA_SIGNING_CA_KEY_PATH},
-                {"UA_SIGNING_CA_KEY_PASS",UA_SIGNING_CA_KEY_PASS}
-            };
-            std::make_shared<http_session>(std::move(socket),params,status_,logger_ptr_)->session_run();
-        }
-        acceptor_.async_accept(boost::asio::make_strand(io_),
-            boost::beast::bind_front_handler(&http_server::on_accept,shared_from_this()));
+            std::make_shared<http_session>(std::move(socket),context_ptr_)->session_run();
+        }
+        do_accept(index);
     }
 }
 
-http_server::http_server(boost::asio::io_context &io, const std::string &app_dir, std::shared_ptr<app_settings> app_settings_ptr, std::shared_ptr<spdlog::logger> logger_ptr)
-    :io_{io},acceptor_{io_},app_dir_{app_dir},app_settings_ptr_{app_settings_ptr},logger_ptr_{logger_ptr}
+http_server::http_server(boost::asio::io_context &io, const std::string &app_dir, std::shared_ptr<app_settings> app_settings_ptr,
+                         std::shared_ptr<task_executor> dbase_executor_ptr, std::shared_ptr<task_executor> crypto_executor_ptr,
+                         std::shared_ptr<dbase_pool> dbase_pool_ptr,
+                         std::shared_ptr<authz_engine> authz_engine_ptr, std::shared_ptr<authz_cache> authz_cache_ptr,
+                         std::shared_ptr<x509_keystore> x509_keystore_ptr, std::shared_ptr<x509_keypair_pool> x509_keypair_pool_ptr,
+                         std::shared_ptr<spdlog::logger> logger_ptr)
+    :status_ptr_{std::make_shared<std::atomic<uc_status>>(uc_status::fail)},io_{io},
+     app_dir_{app_dir},app_settings_ptr_{app_settings_ptr},dbase_executor_ptr_{dbase_executor_ptr},
+     crypto_executor_ptr_{crypto_executor_ptr},dbase_pool_ptr_{dbase_pool_ptr},
+     authz_engine_ptr_{authz_engine_ptr},authz_cache_ptr_{authz_cache_ptr},x509_keystore_ptr_{x509_keystore_ptr},
+     x509_keypair_pool_ptr_{x509_keypair_pool_ptr},logger_ptr_{logger_ptr}
 {
 }
 
@@ -68,63 +133,109 @@ bool http_server::server_listen()
     };
     const unsigned short& UA_PORT_ {static_cast<unsigned short>(std::stoi(UA_PORT))};
 
-    boost::beast::error_code ec;
-    boost::asio::ip::tcp::endpoint ep {boost::asio::ip::address::from_string(UA_HOST),UA_PORT_};
-
-    acceptor_.open(ep.protocol(),ec);
-    if(ec){
-        if(logger_ptr_){
-            logger_ptr_->critical("{}, error message: {}",
-                BOOST_CURRENT_FUNCTION,ec.message());
+    {//build server context once, sessions share it read-only
+        const std::string& UA_DB_NAME {app_settings_ptr_->value_get("UA_DB_NAME")};
+        const std::string& UA_DB_HOST {app_settings_ptr_->value_get("UA_DB_HOST")};
+        const std::string& UA_DB_PORT {app_settings_ptr_->value_get("UA_DB_PORT")};
+        const std::string& UA_DB_USER {app_settings_ptr_->value_get("UA_DB_USER")};
+        const std::string& UA_DB_PASS {app_settings_ptr_->value_get("UA_DB_PASS")};
+        if(UA_DB_NAME.empty() || UA_DB_HOST.empty() || UA_DB_PORT.empty() || UA_DB_USER.empty() || UA_DB_PASS.empty()){
+            if(logger_ptr_){
+                logger_ptr_->critical("{}, db params not defined in app_settings!",
+                    BOOST_CURRENT_FUNCTION);
+            }
+            return false;
         }
-        return false;
-    }
 
-    acceptor_.set_option(boost::asio::socket_base::reuse_address(true), ec);
-    if(ec)
-    {
-        if(logger_ptr_){
-            logger_ptr_->critical("{}, error message: {}",
-                BOOST_CURRENT_FUNCTION,ec.message());
+        const std::shared_ptr<server_context>& context_ptr {std::make_shared<server_context>()};
+        //keep-alive limits, at least one request and one second
+        context_ptr->keep_alive_max=std::max(1,app_settings_ptr_->value_get_int("UA_HTTP_KEEP_ALIVE_MAX",context_ptr->keep_alive_max));
+        context_ptr->keep_alive_timeout=std::max(1,app_settings_ptr_->value_get_int("UA_HTTP_KEEP_ALIVE_TIMEOUT",context_ptr->keep_alive_timeout));
+        context_ptr->stream_lists=app_settings_ptr_->value_get("UA_HTTP_STREAM_LISTS")!="0";
+        {//streams leave at least one dbase worker and one pooled connection to other requests
+            const int& db_workers {std::max(1,app_settings_ptr_->value_get_int("UA_DB_WORKERS",8))};
+            const int& pool_max {std::max(1,app_settings_ptr_->value_get_int("UA_DB_POOL_SIZE_MAX",100))};
+            const int& streams_max {app_settings_ptr_->value_get_int("UA_HTTP_STREAMS_MAX",context_ptr->streams_max)};
+            context_ptr->streams_max=std::max(0,std::min(streams_max,std::min(db_workers,pool_max)-1));
+            context_ptr->streams_active_ptr=std::make_shared<std::atomic<int>>(0);
         }
-        return false;
+        context_ptr->totals_from_counters=app_settings_ptr_->value_get("UA_DB_TOTALS_FROM_COUNTERS")=="1";
+        context_ptr->authz_batch_max=std::max(1,app_settings_ptr_->value_get_int("UA_AUTHZ_BATCH_MAX",context_ptr->authz_batch_max));
+        {//PKCS12 profile, 0 iterations keep the profile defaults
+            const std::string& UA_PKCS12_PROFILE {app_settings_ptr_->value_get("UA_PKCS12_PROFILE")};
+            context_ptr->pkcs12=x509_generator::pkcs12_profile_make(UA_PKCS12_PROFILE,
+                                                                    app_settings_ptr_->value_get_int("UA_PKCS12_ITERATIONS",0),
+                                                                    app_settings_ptr_->value_get_int("UA_PKCS12_MAC_ITERATIONS",0));
+            if(context_ptr->pkcs12.name!=UA_PKCS12_PROFILE && logger_ptr_){
+                logger_ptr_->warn("{}, unknown PKCS12 profile '{}', '{}' used",
+                    BOOST_CURRENT_FUNCTION,UA_PKCS12_PROFILE,context_ptr->pkcs12.name);
+            }
+        }
+
+        context_ptr->status_ptr=status_ptr_;
+        context_ptr->dbase_executor_ptr=dbase_executor_ptr_;
+        context_ptr->crypto_executor_ptr=crypto_executor_ptr_;
+        context_ptr->dbase_pool_ptr=dbase_pool_ptr_;
+        context_ptr->authz_engine_ptr=authz_engine_ptr_;
+        context_ptr->authz_cache_ptr=authz_cache_ptr_;
+        context_ptr->x509_keystore_ptr=x509_keystore_ptr_;
+        context_ptr->x509_keypair_pool_ptr=x509_keypair_pool_ptr_;
+        context_ptr->logger_ptr=logger_ptr_;
+        context_ptr_=context_ptr;
     }
 
-    //bind to the server address
-    acceptor_.bind(ep, ec);
-    if(ec){
-        if(logger_ptr_){
-            logger_ptr_->critical("{}, error message: {}",
-                BOOST_CURRENT_FUNCTION,ec.message());
+    boost::asio::ip::tcp::endpoint ep {boost::asio::ip::address::from_string(UA_HOST),UA_PORT_};
+
+    //resolved by app_settings::io_model_get, main sized its io threads from the same value
+    io_model_=app_settings_ptr_->value_get("UA_IO_MODEL");
+    if(io_model_=="sharded"){
+        //0 means one shard per core
+        const int& shards {app_settings_ptr_->value_get_int("UA_IO_SHARDS",0)};
+        const std::size_t& shards_count {shards>0 ? static_cast<std::size_t>(shards) :
+                                                    static_cast<std::size_t>(std::max(1u,std::thread::hardware_concurrency()))};
+        const bool& pin_threads {app_settings_ptr_->value_get("UA_IO_PIN_THREADS")=="1"};
+        io_shards_ptr_=std::make_shared<io_shards>(shards_count,pin_threads,logger_ptr_);
+        for(std::size_t i=0;i<io_shards_ptr_->shards_count();++i){
+            acceptors_.push_back(std::make_shared<boost::asio::ip::tcp::acceptor>(io_shards_ptr_->shard_get(i)));
+            if(!acceptor_open(*acceptors_.back(),ep,true)){
+                acceptors_.clear();
+                io_shards_ptr_.reset();
+                return false;
+            }
         }
-        return false;
     }
-
-    //start listening for connections
-    acceptor_.listen(boost::asio::socket_base::max_listen_connections, ec);
-    if(ec){
-        if(logger_ptr_){
-            logger_ptr_->critical("{}, error message: {}",
-                BOOST_CURRENT_FUNCTION,ec.message());
+    else{
+        acceptors_.push_back(std::make_shared<boost::asio::ip::tcp::acceptor>(io_));
+        if(!acceptor_open(*acceptors_.back(),ep,false)){
+            acceptors_.clear();
+            return false;
         }
-        return false;
     }
     if(logger_ptr_){
-        logger_ptr_->info("{}, http_uauth_server begin accept",
-            BOOST_CURRENT_FUNCTION);
+        logger_ptr_->info("{}, http_uauth_server begin accept, io model: {}, acceptors: {}",
+            BOOST_CURRENT_FUNCTION,io_model_,acceptors_.size());
     }
 
-    acceptor_.async_accept(boost::asio::make_strand(io_),
-        boost::beast::bind_front_handler(&http_server::on_accept,shared_from_this()));
+    for(std::size_t i=0;i<acceptors_.size();++i){
+        do_accept(i);
+    }
+    if(io_shards_ptr_){
+        io_shards_ptr_->shards_start();
+    }
     return true;
 }
 
 void http_server::server_stop()
 {
+    if(io_shards_ptr_){//shard threads joined, acceptors no longer in use
+        io_shards_ptr_->shards_stop();
+    }
     boost::system::error_code ec;
-    if(acceptor_.is_open()){
-        acceptor_.cancel(ec);
-        acceptor_.close(ec);
+    for(const std::shared_ptr<boost::asio::ip::tcp::acceptor>& acceptor_ptr: acceptors_){
+        if(acceptor_ptr->is_open()){
+            acceptor_ptr->cancel(ec);
+            acceptor_ptr->close(ec);
+        }
     }
     if(logger_ptr_){
         logger_ptr_->info("{}, http_server stopped",
@@ -134,7 +245,7 @@ void http_server::server_stop()
 
 void http_server::uc_status_slot(uc_status status, const std::string &msg)
 {
-    status_=status;
+    status_ptr_->store(status);
     const auto& to_string{[](uc_status status){
             switch(status){
             case uc_status::fail:
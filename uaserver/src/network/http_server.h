@@ -2,8 +2,10 @@
 #define HTTP_SERVER_H
 #include "defines.h"
 
+#include <atomic>
 #include <string>
 #include <memory>
+#include <vector>
 #include <boost/asio.hpp>
 #include <boost/json.hpp>
 #include <boost/beast.hpp>
@@ -12,23 +14,49 @@ namespace spdlog{
     class logger;
 }
 class app_settings;
+class task_executor;
+class dbase_pool;
+class authz_engine;
+class authz_cache;
+class x509_keystore;
+class x509_keypair_pool;
+class io_shards;
+struct server_context;
 
 class http_server:public std::enable_shared_from_this<http_server>
 {
 private:
-    uc_status status_ {uc_status::fail};
+    std::shared_ptr<std::atomic<uc_status>> status_ptr_ {nullptr};
     boost::asio::io_context& io_;
-    boost::asio::ip::tcp::acceptor acceptor_;
+    //"shared": one acceptor on io_, "sharded": one SO_REUSEPORT acceptor per io shard
+    std::string io_model_ {"shared"};
+    std::shared_ptr<io_shards> io_shards_ptr_ {nullptr};
+    std::vector<std::shared_ptr<boost::asio::ip::tcp::acceptor>> acceptors_ {};
 
     std::string app_dir_ {};
-    boost::json::object params_ {};
+    //immutable after server_listen, one per server instead of a params copy per session
+    std::shared_ptr<const server_context> context_ptr_ {nullptr};
     std::shared_ptr<app_settings> app_settings_ptr_ {nullptr};
+    std::shared_ptr<task_executor> dbase_executor_ptr_ {nullptr};
+    std::shared_ptr<task_executor> crypto_executor_ptr_ {nullptr};
+    std::shared_ptr<dbase_pool> dbase_pool_ptr_ {nullptr};
+    std::shared_ptr<authz_engine> authz_engine_ptr_ {nullptr};
+    std::shared_ptr<authz_cache> authz_cache_ptr_ {nullptr};
+    std::shared_ptr<x509_keystore> x509_keystore_ptr_ {nullptr};
+    std::shared_ptr<x509_keypair_pool> x509_keypair_pool_ptr_ {nullptr};
     std::shared_ptr<spdlog::logger> logger_ptr_ {nullptr};
 
-    void on_accept(boost::beast::error_code ec,boost::asio::ip::tcp::socket socket);
+    bool acceptor_open(boost::asio::ip::tcp::acceptor& acceptor,const boost::asio::ip::tcp::endpoint& ep,bool reuse_port);
+    void do_accept(std::size_t index);
+    void on_accept(std::size_t index,boost::beast::error_code ec,boost::asio::ip::tcp::socket socket);
 
 public:
-    explicit http_server(boost::asio::io_context& io,const std::string& app_dir,std::shared_ptr<app_settings> app_settings_ptr,std::shared_ptr<spdlog::logger> logger_ptr);
+    explicit http_server(boost::asio::io_context& io,const std::string& app_dir,std::shared_ptr<app_settings> app_settings_ptr,
+                         std::shared_ptr<task_executor> dbase_executor_ptr,std::shared_ptr<task_executor> crypto_executor_ptr,
+                         std::shared_ptr<dbase_pool> dbase_pool_ptr,
+                         std::shared_ptr<authz_engine> authz_engine_ptr,std::shared_ptr<authz_cache> authz_cache_ptr,
+                         std::shared_ptr<x509_keystore> x509_keystore_ptr,std::shared_ptr<x509_keypair_pool> x509_keypair_pool_ptr,
+                         std::shared_ptr<spdlog::logger> logger_ptr);
     bool server_listen();
     void server_stop();
     void uc_status_slot(uc_status status,const std::string& msg);
@@ -1,4 +1,7 @@
 #include "http_session.h"
+#include "server_context.h"
+#include "executor/task_executor.h"
+
 #include <chrono>
 #include <boost/url.hpp>
 
@@ -7,7 +10,7 @@
 void http_session::do_read()
 {
     request_={};
-    stream_.expires_after(std::chrono::seconds(60));
+    stream_.expires_after(keep_alive_timeout_);
     boost::beast::http::async_read(stream_,buffer_,request_,
         boost::beast::bind_front_handler(&http_session::on_read,shared_from_this()));
 }
@@ -20,35 +23,200 @@ void http_session::do_close()
 
 void http_session::on_read(boost::beast::error_code ec, size_t bytes_transferred)
 {
-    if(ec==boost::beast::http::error::end_of_stream || ec){
-        if(logger_ptr_){
-            logger_ptr_->error("{}, close session with error: {}",
+    //peer closed or idle keep-alive connection expired
+    if(ec==boost::beast::http::error::end_of_stream || ec==boost::beast::error::timeout){
+        if(context_ptr_->logger_ptr){
+            context_ptr_->logger_ptr->debug("{}, close session after {} requests: {}",
+                BOOST_CURRENT_FUNCTION,requests_count_,ec.message());
+        }
+        return do_close();
+    }
+    if(ec){
+        if(context_ptr_->logger_ptr){
+            context_ptr_->logger_ptr->error("{}, close session with error: {}",
                 BOOST_CURRENT_FUNCTION,ec.message());
         }
         return do_close();
     }
-    http::message_generator response=
-        handle_request(std::move(request_));
+    //last allowed request on this connection, answer with 'Connection: close'
+    if(++requests_count_>=context_ptr_->keep_alive_max){
+        request_.keep_alive(false);
+    }
+
+    //handle request on dbase or crypto executor, write response back on the session executor
+    const std::shared_ptr<http_session>& self {shared_from_this()};
+    const bool& crypto {http_handler_.is_crypto(request_)};
+    const std::shared_ptr<task_executor>& executor_ptr {crypto ? context_ptr_->crypto_executor_ptr : context_ptr_->dbase_executor_ptr};
+    std::shared_ptr<chunk_stream> stream_ptr {nullptr};
+    bool streamed {http_handler_.is_streamed(request_)};
+    if(streamed && context_ptr_->streams_active_ptr->fetch_add(1)>=context_ptr_->streams_max){//no stream slot, answer buffered
+        context_ptr_->streams_active_ptr->fetch_sub(1);
+        streamed=false;
+    }
+    if(streamed){//list rows are written as chunks while read from libpq
+        chunk_response_={http::status::ok,request_.version()};
+        chunk_response_.keep_alive(request_.keep_alive());
+        stream_ptr=std::make_shared<chunk_stream>(context_ptr_->stream_chunks_max,[self](){
+            boost::asio::post(self->stream_.get_executor(),[self](){
+                self->do_write_chunk();
+            });
+        });
+        chunk_stream_ptr_=stream_ptr;
+    }
+    const std::shared_ptr<http::request<http::string_body>>& request_ptr {
+        std::make_shared<http::request<http::string_body>>(std::move(request_))};
+    const bool& posted {executor_ptr->task_post([self,request_ptr,stream_ptr](){
+        //version and keep-alive outlive the moved request, a thrown handler still gets its 500
+        http::request<http::string_body> request_head {request_ptr->method(),request_ptr->target(),request_ptr->version()};
+        request_head.keep_alive(request_ptr->keep_alive());
+        std::shared_ptr<http::message_generator> response_ptr {nullptr};
+        std::string error {};
+        try{
+            response_ptr=std::make_shared<http::message_generator>(self->handle_request(std::move(*request_ptr),stream_ptr.get()));
+        }
+        catch(const std::exception& ex){
+            error=ex.what();
+        }
+        catch(...){
+            error="unknown exception";
+        }
+        if(stream_ptr){//producer is done, slot is free
+            self->context_ptr_->streams_active_ptr->fetch_sub(1);
+        }
+        if(!response_ptr){
+            if(self->context_ptr_->logger_ptr){
+                self->context_ptr_->logger_ptr->error("{}, request failed: {}",
+                    BOOST_CURRENT_FUNCTION,error);
+            }
+            if(stream_ptr && stream_ptr->is_begun()){//headers already went out, end the stream without last chunk
+                stream_ptr->stream_finish(true);
+                return;
+            }
+            response_ptr=std::make_shared<http::message_generator>(self->http_handler_.handle_internal_error(std::move(request_head)));
+        }
+        if(stream_ptr && stream_ptr->is_begun()){//body went out as chunks, returned response is a placeholder
+            return;
+        }
+        boost::asio::post(self->stream_.get_executor(),[self,response_ptr](){
+            self->chunk_stream_reset();
+            self->do_write(std::move(*response_ptr));
+        });
+    })};
+    if(!posted){
+        if(context_ptr_->logger_ptr){
+            context_ptr_->logger_ptr->warn("{}, {} executor queue is full",
+                BOOST_CURRENT_FUNCTION,crypto ? "crypto" : "dbase");
+        }
+        if(stream_ptr){
+            context_ptr_->streams_active_ptr->fetch_sub(1);
+        }
+        chunk_stream_reset();
+        do_write(http_handler_.handle_unavailable(std::move(*request_ptr)));
+    }
+}
+
+void http_session::do_write(http::message_generator &&response)
+{
+    const bool keep_alive {response.keep_alive()};
+    stream_.expires_after(std::chrono::seconds(30));
     boost::beast::async_write(stream_,std::move(response),
-        boost::beast::bind_front_handler(&http_session::on_write,shared_from_this()));
+        boost::beast::bind_front_handler(&http_session::on_write,shared_from_this(),keep_alive));
 }
 
-void http_session::on_write(error_code ec, size_t bytes_transferred)
+void http_session::on_write(bool keep_alive, error_code ec, size_t bytes_transferred)
 {
     if(ec){
-        if(logger_ptr_){
-            logger_ptr_->error("{},{}",
+        if(context_ptr_->logger_ptr){
+            context_ptr_->logger_ptr->error("{},{}",
                 BOOST_CURRENT_FUNCTION,ec.message());
         }
         return;
     }
-    return do_close();
+    if(!keep_alive){
+        return do_close();
+    }
+    do_read();
+}
+
+void http_session::do_write_chunk()
+{
+    if(chunk_writing_ || !chunk_stream_ptr_){
+        return;
+    }
+    stream_.expires_after(std::chrono::seconds(30));
+    if(!chunk_serializer_ptr_){//status line and headers first
+        chunk_response_.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+        chunk_response_.set(http::field::content_type,"application/json");
+        chunk_response_.chunked(true);
+        chunk_serializer_ptr_.reset(new http::response_serializer<http::empty_body> {chunk_response_});
+        chunk_writing_=true;
+        http::async_write_header(stream_,*chunk_serializer_ptr_,
+            boost::beast::bind_front_handler(&http_session::on_write_chunk,shared_from_this()));
+        return;
+    }
+    switch(chunk_stream_ptr_->chunk_pop(chunk_)){
+    case chunk_state::empty:
+        return;
+    case chunk_state::chunk:
+        chunk_writing_=true;
+        boost::asio::async_write(stream_,http::make_chunk(boost::asio::buffer(chunk_)),
+            boost::beast::bind_front_handler(&http_session::on_write_chunk,shared_from_this()));
+        return;
+    case chunk_state::finished:
+        chunk_writing_=true;
+        chunk_last_=true;
+        boost::asio::async_write(stream_,http::make_chunk_last(),
+            boost::beast::bind_front_handler(&http_session::on_write_chunk,shared_from_this()));
+        return;
+    case chunk_state::failed:
+        //no last chunk, client sees truncated body
+        if(context_ptr_->logger_ptr){
+            context_ptr_->logger_ptr->error("{}, list stream failed after headers were sent",
+                BOOST_CURRENT_FUNCTION);
+        }
+        chunk_stream_reset();
+        return do_close();
+    }
+}
+
+void http_session::on_write_chunk(boost::beast::error_code ec, std::size_t bytes_transferred)
+{
+    chunk_writing_=false;
+    if(ec){
+        if(context_ptr_->logger_ptr){
+            context_ptr_->logger_ptr->error("{},{}",
+                BOOST_CURRENT_FUNCTION,ec.message());
+        }
+        chunk_stream_reset();
+        return do_close();
+    }
+    if(chunk_last_){
+        const bool keep_alive {chunk_response_.keep_alive()};
+        chunk_stream_reset();
+        if(!keep_alive){
+            return do_close();
+        }
+        return do_read();
+    }
+    do_write_chunk();
+}
+
+void http_session::chunk_stream_reset()
+{
+    if(chunk_stream_ptr_){//wakes a producer still waiting for queue space
+        chunk_stream_ptr_->stream_cancel();
+    }
+    chunk_stream_ptr_.reset();
+    chunk_serializer_ptr_.reset();
+    chunk_response_={};
+    chunk_.clear();
+    chunk_last_=false;
 }
 
-http_session::http_session(boost::asio::ip::tcp::socket &&socket, const boost::json::object &params, uc_status status, std::shared_ptr<spdlog::logger> logger_ptr)
-    :stream_{std::move(socket)},params_{params},logger_ptr_{logger_ptr}
+http_session::http_session(boost::asio::ip::tcp::socket &&socket, std::shared_ptr<const server_context> context_ptr)
+    :stream_{std::move(socket)},keep_alive_timeout_{context_ptr->keep_alive_timeout},
+     context_ptr_{context_ptr},http_handler_{*context_ptr_}
 {
-    http_handler_ptr_.reset(new http_handler{params_,status,logger_ptr});
 }
 
 void http_session::session_run()
@@ -1,6 +1,8 @@
 #ifndef HTTP_SESSION_H
 #define HTTP_SESSION_H
 
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <memory>
 #include <boost/json.hpp>
@@ -9,36 +11,52 @@
 #include <boost/beast/http/message_generator.hpp>
 
 #include "http_handler.h"
+#include "chunk_stream.h"
 
 namespace spdlog{
     class logger;
 }
+struct server_context;
 using namespace boost::beast;
 
 class http_session:public std::enable_shared_from_this<http_session>
 {
 private:
     boost::beast::tcp_stream stream_;
-    boost::json::object params_ {};
+    int requests_count_ {0};
+    std::chrono::seconds keep_alive_timeout_ {60};
     boost::beast::flat_buffer buffer_;
-    std::shared_ptr<std::string> reponse_body_ {nullptr};
     http::request<http::string_body> request_;
 
-    std::shared_ptr<http_handler> http_handler_ptr_ {nullptr};
-    std::shared_ptr<spdlog::logger> logger_ptr_ {nullptr};
+    //declared before http_handler_, which keeps a reference to it
+    std::shared_ptr<const server_context> context_ptr_ {nullptr};
+    http_handler http_handler_;
+
+    //chunked list response, touched only on the session executor
+    std::shared_ptr<chunk_stream> chunk_stream_ptr_ {nullptr};
+    http::response<http::empty_body> chunk_response_ {};
+    std::unique_ptr<http::response_serializer<http::empty_body>> chunk_serializer_ptr_ {nullptr};
+    std::string chunk_ {};
+    bool chunk_writing_ {false};
+    bool chunk_last_ {false};
 
     void do_read();
     void do_close();
+    void do_write(http::message_generator&& response);
     void on_read(boost::beast::error_code ec,std::size_t bytes_transferred);
-    void on_write(boost::beast::error_code ec,std::size_t bytes_transferred);
+    void on_write(bool keep_alive,boost::beast::error_code ec,std::size_t bytes_transferred);
+    //write headers once, then queued chunks, then last chunk
+    void do_write_chunk();
+    void on_write_chunk(boost::beast::error_code ec,std::size_t bytes_transferred);
+    void chunk_stream_reset();
 
     template <class Body, class Allocator>
-    http::message_generator handle_request(http::request<Body, http::basic_fields<Allocator>>&& request){
-        return http_handler_ptr_->handle_request(std::move(request));
+    http::message_generator handle_request(http::request<Body, http::basic_fields<Allocator>>&& request,chunk_stream* stream_ptr){
+        return http_handler_.handle_request(std::move(request),stream_ptr);
     }
 
 public:
-    explicit http_session(boost::asio::ip::tcp::socket&& socket,const boost::json::object& params,uc_status status,std::shared_ptr<spdlog::logger> logger_ptr);
+    explicit http_session(boost::asio::ip::tcp::socket&& socket,std::shared_ptr<const server_context> context_ptr);
     void session_run();
 };
 
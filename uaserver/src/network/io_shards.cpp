@@ -0,0 +1,97 @@
+#include "io_shards.h"
+
+#include <algorithm>
+#include <boost/predef/os.h>
+#include <boost/core/ignore_unused.hpp>
+#include "spdlog/spdlog.h"
+
+#if BOOST_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+void io_shards::thread_pin(std::thread &thread, std::size_t index)
+{
+#if BOOST_OS_LINUX
+    const unsigned int& cores {std::max(1u,std::thread::hardware_concurrency())};
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(index%cores,&cpu_set);
+    const int& rc {pthread_setaffinity_np(thread.native_handle(),sizeof(cpu_set_t),&cpu_set)};
+    if(rc && logger_ptr_){
+        logger_ptr_->warn("{}, pin shard {} failed, error: {}",
+            BOOST_CURRENT_FUNCTION,index,rc);
+    }
+#else
+    boost::ignore_unused(thread,index);
+#endif
+}
+
+io_shards::io_shards(std::size_t shards_count, bool pin_threads, std::shared_ptr<spdlog::logger> logger_ptr)
+    :pin_threads_{pin_threads},logger_ptr_{logger_ptr}
+{
+    shards_count=std::max<std::size_t>(1,shards_count);
+    contexts_.reserve(shards_count);
+    guards_.reserve(shards_count);
+    arenas_.reserve(shards_count);
+    for(std::size_t i=0;i<shards_count;++i){
+        //single thread per context, scheduler can skip locking
+        contexts_.push_back(std::make_shared<boost::asio::io_context>(1));
+        guards_.push_back(boost::asio::make_work_guard(*contexts_.back()));
+        arenas_.push_back(std::make_shared<shard_arena>(1024));
+    }
+}
+
+io_shards::~io_shards()
+{
+    shards_stop();
+}
+
+void io_shards::shards_start()
+{
+    threads_.reserve(contexts_.size());
+    for(std::size_t i=0;i<contexts_.size();++i){
+        const std::shared_ptr<boost::asio::io_context>& io_ptr {contexts_[i]};
+        threads_.emplace_back([io_ptr](){
+            io_ptr->run();
+        });
+        if(pin_threads_){
+            thread_pin(threads_.back(),i);
+        }
+    }
+    if(logger_ptr_){
+        logger_ptr_->info("{}, io shards started: {}, pinned: {}",
+            BOOST_CURRENT_FUNCTION,contexts_.size(),pin_threads_);
+    }
+}
+
+void io_shards::shards_stop()
+{
+    for(auto& guard: guards_){
+        guard.reset();
+    }
+    for(const std::shared_ptr<boost::asio::io_context>& io_ptr: contexts_){
+        io_ptr->stop();
+    }
+    for(std::thread& thread: threads_){
+        if(thread.joinable() && thread.get_id()!=std::this_thread::get_id()){
+            thread.join();
+        }
+    }
+    threads_.clear();
+}
+
+std::size_t io_shards::shards_count() const
+{
+    return contexts_.size();
+}
+
+boost::asio::io_context &io_shards::shard_get(std::size_t index)
+{
+    return *contexts_.at(index%contexts_.size());
+}
+
+std::shared_ptr<shard_arena> io_shards::arena_get(std::size_t index)
+{
+    return arenas_.at(index%arenas_.size());
+}
@@ -0,0 +1,42 @@
+#ifndef IO_SHARDS_H
+#define IO_SHARDS_H
+
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <boost/asio.hpp>
+
+#include "shard_arena.h"
+
+namespace spdlog{
+    class logger;
+}
+
+//One io_context per shard, each run by its own thread, optionally pinned to a core
+class io_shards
+{
+private:
+    bool pin_threads_ {false};
+    std::vector<std::shared_ptr<boost::asio::io_context>> contexts_ {};
+    std::vector<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> guards_ {};
+    std::vector<std::thread> threads_ {};
+    //session memory per shard, reused by the sessions its acceptor creates
+    std::vector<std::shared_ptr<shard_arena>> arenas_ {};
+    std::shared_ptr<spdlog::logger> logger_ptr_ {nullptr};
+
+    void thread_pin(std::thread& thread,std::size_t index);
+
+public:
+    explicit io_shards(std::size_t shards_count,bool pin_threads,std::shared_ptr<spdlog::logger> logger_ptr);
+    ~io_shards();
+
+    void shards_start();
+    //Stop all contexts and join threads, sessions still open are dropped
+    void shards_stop();
+    std::size_t shards_count() const;
+    boost::asio::io_context& shard_get(std::size_t index);
+    std::shared_ptr<shard_arena> arena_get(std::size_t index);
+};
+
+#endif // IO_SHARDS_H
@@ -0,0 +1,57 @@
+#ifndef SERVER_CONTEXT_H
+#define SERVER_CONTEXT_H
+#include "defines.h"
+#include "x509/pkcs12_profile.h"
+
+#include <atomic>
+#include <string>
+#include <cstddef>
+#include <memory>
+
+namespace spdlog{
+    class logger;
+}
+class task_executor;
+class dbase_pool;
+class authz_engine;
+class authz_cache;
+class x509_keystore;
+class x509_keypair_pool;
+
+//Built once in http_server::server_listen, shared read-only by all sessions
+struct server_context
+{
+    //http keep-alive, requests per connection and idle timeout in seconds
+    int keep_alive_max {100};
+    int keep_alive_timeout {60};
+    //list endpoints answer HTTP/1.1 clients with chunked bodies of about stream_chunk_size bytes,
+    //at most stream_chunks_max chunks queued per session
+    bool stream_lists {true};
+    std::size_t stream_chunk_size {16384};
+    std::size_t stream_chunks_max {4};
+    //streams running at once, a producer blocks its dbase worker and connection while the peer reads,
+    //past the cap lists are answered buffered
+    int streams_max {4};
+    std::shared_ptr<std::atomic<int>> streams_active_ptr {nullptr};
+    //unfiltered list totals from trigger-maintained table_counters
+    bool totals_from_counters {false};
+    //entries accepted by one POST /authz/batch
+    int authz_batch_max {100};
+    //encryption and MAC of issued user PKCS12
+    pkcs12_profile pkcs12 {};
+
+    std::shared_ptr<std::atomic<uc_status>> status_ptr {nullptr};
+    std::shared_ptr<task_executor> dbase_executor_ptr {nullptr};
+    //certificate issuance, kept apart so key and PKCS12 work can not starve authz checks
+    std::shared_ptr<task_executor> crypto_executor_ptr {nullptr};
+    std::shared_ptr<dbase_pool> dbase_pool_ptr {nullptr};
+    std::shared_ptr<authz_engine> authz_engine_ptr {nullptr};
+    std::shared_ptr<authz_cache> authz_cache_ptr {nullptr};
+    //parsed CA chain and decrypted signing key
+    std::shared_ptr<x509_keystore> x509_keystore_ptr {nullptr};
+    //pre-generated per-user keys for PKCS12
+    std::shared_ptr<x509_keypair_pool> x509_keypair_pool_ptr {nullptr};
+    std::shared_ptr<spdlog::logger> logger_ptr {nullptr};
+};
+
+#endif // SERVER_CONTEXT_H
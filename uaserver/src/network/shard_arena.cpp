@@ -0,0 +1,43 @@
+#include "shard_arena.h"
+
+#include <new>
+
+shard_arena::shard_arena(std::size_t blocks_max)
+    :blocks_max_{blocks_max}
+{
+}
+
+shard_arena::~shard_arena()
+{
+    for(void* block: blocks_){
+        ::operator delete(block);
+    }
+}
+
+void *shard_arena::block_get(std::size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        if(!block_size_){
+            block_size_=size;
+        }
+        if(size==block_size_ && !blocks_.empty()){
+            void* block {blocks_.back()};
+            blocks_.pop_back();
+            return block;
+        }
+    }
+    return ::operator new(size);
+}
+
+void shard_arena::block_put(void *block, std::size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        if(size==block_size_ && blocks_.size()<blocks_max_){
+            blocks_.push_back(block);
+            return;
+        }
+    }
+    ::operator delete(block);
+}
@@ -0,0 +1,71 @@
+#ifndef SHARD_ARENA_H
+#define SHARD_ARENA_H
+
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+//Free list of session blocks owned by one io shard, a closed session leaves its block
+//for the next one accepted on the shard instead of returning it to the global heap.
+//Blocks are first touched by the shard thread; release takes a mutex because the
+//last session reference can drop on a dbase or crypto worker
+class shard_arena
+{
+private:
+    std::mutex mutex_;
+    //size of the first block asked for, other sizes bypass the free list
+    std::size_t block_size_ {0};
+    std::size_t blocks_max_ {1024};
+    std::vector<void*> blocks_ {};
+
+public:
+    explicit shard_arena(std::size_t blocks_max);
+    ~shard_arena();
+    shard_arena(const shard_arena&)=delete;
+    shard_arena& operator=(const shard_arena&)=delete;
+
+    void* block_get(std::size_t size);
+    void block_put(void* block,std::size_t size);
+};
+
+//Allocator for std::allocate_shared, the control block keeps the arena alive
+//until the last session allocated from it is gone
+template <class T>
+class shard_allocator
+{
+private:
+    template <class U> friend class shard_allocator;
+    std::shared_ptr<shard_arena> arena_ptr_ {nullptr};
+
+public:
+    typedef T value_type;
+
+    explicit shard_allocator(std::shared_ptr<shard_arena> arena_ptr)
+        :arena_ptr_{arena_ptr}
+    {
+    }
+    template <class U>
+    shard_allocator(const shard_allocator<U>& other)
+        :arena_ptr_{other.arena_ptr_}
+    {
+    }
+
+    T* allocate(std::size_t n){
+        return static_cast<T*>(arena_ptr_->block_get(n*sizeof(T)));
+    }
+    void deallocate(T* p,std::size_t n){
+        arena_ptr_->block_put(p,n*sizeof(T));
+    }
+
+    template <class U>
+    bool operator==(const shard_allocator<U>& other) const{
+        return arena_ptr_==other.arena_ptr_;
+    }
+    template <class U>
+    bool operator!=(const shard_allocator<U>& other) const{
+        return arena_ptr_!=other.arena_ptr_;
+    }
+};
+
+#endif // SHARD_ARENA_H
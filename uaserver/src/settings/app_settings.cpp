@@ -4,6 +4,8 @@
 #include <fstream>
 #include <sstream>
 #include "spdlog/spdlog.h"
+#include <boost/predef/os.h>
+#include <boost/current_function.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ini_parser.hpp>
@@ -13,6 +15,17 @@ app_settings::app_settings(std::string etc_uauth_dir, std::shared_ptr<spdlog::lo
 {
 }
 
+std::string app_settings::io_model_get()
+{
+#if BOOST_OS_LINUX
+    const char* UA_IO_MODEL {std::getenv("UA_IO_MODEL")};
+    if(UA_IO_MODEL!=NULL && std::string {UA_IO_MODEL}=="sharded"){
+        return "sharded";
+    }
+#endif
+    return "shared";
+}
+
 bool app_settings::settings_init()
 {
     //uauth server params
@@ -42,6 +55,13 @@ bool app_settings::settings_init()
     const std::string& UA_SIGNING_CA_CRT_PATH=std::getenv("UA_SIGNING_CA_CRT_PATH")==NULL ? "" : std::getenv("UA_SIGNING_CA_CRT_PATH");
     const std::string& UA_SIGNING_CA_KEY_PATH=std::getenv("UA_SIGNING_CA_KEY_PATH")==NULL ? "" : std::getenv("UA_SIGNING_CA_KEY_PATH");
     const std::string& UA_SIGNING_CA_KEY_PASS=std::getenv("UA_SIGNING_CA_KEY_PASS")==NULL ? "" : std::getenv("UA_SIGNING_CA_KEY_PASS");
+    const std::string& UA_CA_RELOAD_INTERVAL=std::getenv("UA_CA_RELOAD_INTERVAL")==NULL ? "30" : std::getenv("UA_CA_RELOAD_INTERVAL");
+    const std::string& UA_PKCS12_PROFILE=std::getenv("UA_PKCS12_PROFILE")==NULL ? "aes256" : std::getenv("UA_PKCS12_PROFILE");
+    const std::string& UA_PKCS12_ITERATIONS=std::getenv("UA_PKCS12_ITERATIONS")==NULL ? "20000" : std::getenv("UA_PKCS12_ITERATIONS");
+    const std::string& UA_PKCS12_MAC_ITERATIONS=std::getenv("UA_PKCS12_MAC_ITERATIONS")==NULL ? "2048" : std::getenv("UA_PKCS12_MAC_ITERATIONS");
+    const std::string& UA_PKCS12_KEY_TYPE=std::getenv("UA_PKCS12_KEY_TYPE")==NULL ? "rsa2048" : std::getenv("UA_PKCS12_KEY_TYPE");
+    const std::string& UA_KEYPAIR_POOL_SIZE=std::getenv("UA_KEYPAIR_POOL_SIZE")==NULL ? "32" : std::getenv("UA_KEYPAIR_POOL_SIZE");
+    const std::string& UA_KEYPAIR_POOL_THREADS=std::getenv("UA_KEYPAIR_POOL_THREADS")==NULL ? "1" : std::getenv("UA_KEYPAIR_POOL_THREADS");
 
     //ucontrol certificates part
     const std::string& UA_CLIENT_CRT_PATH=std::getenv("UA_CLIENT_CRT_PATH")==NULL ? "" : std::getenv("UA_CLIENT_CRT_PATH");
@@ -52,6 +72,51 @@ bool app_settings::settings_init()
     const std::string& UA_SENTRY_DSN=std::getenv("UA_SENTRY_DSN")==NULL ? "" : std::getenv("UA_SENTRY_DSN");
     const std::string& UA_SENTRY_TRACES_SAMPLE_RATE=std::getenv("UA_SENTRY_TRACES_SAMPLE_RATE")==NULL ? "" : std::getenv("UA_SENTRY_TRACES_SAMPLE_RATE");
 
+    //http keep-alive params
+    const std::string& UA_HTTP_KEEP_ALIVE_MAX=std::getenv("UA_HTTP_KEEP_ALIVE_MAX")==NULL ? "100" : std::getenv("UA_HTTP_KEEP_ALIVE_MAX");
+    const std::string& UA_HTTP_KEEP_ALIVE_TIMEOUT=std::getenv("UA_HTTP_KEEP_ALIVE_TIMEOUT")==NULL ? "60" : std::getenv("UA_HTTP_KEEP_ALIVE_TIMEOUT");
+    //"1" streams list bodies with chunked transfer encoding to HTTP/1.1 clients
+    const std::string& UA_HTTP_STREAM_LISTS=std::getenv("UA_HTTP_STREAM_LISTS")==NULL ? "1" : std::getenv("UA_HTTP_STREAM_LISTS");
+    //lists streamed at once, each holds a dbase worker and a pooled connection while the client reads,
+    //kept below UA_DB_WORKERS and UA_DB_POOL_SIZE_MAX, further lists are answered buffered
+    const std::string& UA_HTTP_STREAMS_MAX=std::getenv("UA_HTTP_STREAMS_MAX")==NULL ? "4" : std::getenv("UA_HTTP_STREAMS_MAX");
+
+    //io model params, "shared" or "sharded", shards "0" is one per core, "1" pins shard threads
+    const std::string& UA_IO_MODEL {io_model_get()};
+    if(std::getenv("UA_IO_MODEL")!=NULL && UA_IO_MODEL!=std::getenv("UA_IO_MODEL") && logger_ptr_){
+        logger_ptr_->warn("{}, UA_IO_MODEL '{}' not supported here, '{}' used",
+            BOOST_CURRENT_FUNCTION,std::getenv("UA_IO_MODEL"),UA_IO_MODEL);
+    }
+    const std::string& UA_IO_SHARDS=std::getenv("UA_IO_SHARDS")==NULL ? "0" : std::getenv("UA_IO_SHARDS");
+    const std::string& UA_IO_PIN_THREADS=std::getenv("UA_IO_PIN_THREADS")==NULL ? "0" : std::getenv("UA_IO_PIN_THREADS");
+
+    //dbase executor params
+    const std::string& UA_DB_WORKERS=std::getenv("UA_DB_WORKERS")==NULL ? "8" : std::getenv("UA_DB_WORKERS");
+    const std::string& UA_DB_QUEUE_MAX=std::getenv("UA_DB_QUEUE_MAX")==NULL ? "1024" : std::getenv("UA_DB_QUEUE_MAX");
+    const std::string& UA_CRYPTO_WORKERS=std::getenv("UA_CRYPTO_WORKERS")==NULL ? "2" : std::getenv("UA_CRYPTO_WORKERS");
+    const std::string& UA_CRYPTO_QUEUE_MAX=std::getenv("UA_CRYPTO_QUEUE_MAX")==NULL ? "64" : std::getenv("UA_CRYPTO_QUEUE_MAX");
+
+    //dbase pool params, seconds and milliseconds
+    const std::string& UA_DB_CONN_MAX_LIFETIME=std::getenv("UA_DB_CONN_MAX_LIFETIME")==NULL ? "1800" : std::getenv("UA_DB_CONN_MAX_LIFETIME");
+    const std::string& UA_DB_POOL_ACQUIRE_TIMEOUT=std::getenv("UA_DB_POOL_ACQUIRE_TIMEOUT")==NULL ? "5000" : std::getenv("UA_DB_POOL_ACQUIRE_TIMEOUT");
+
+    //"auto" keeps a LISTEN connection for changes made by other instances when uatables installed its triggers,
+    //"1" always, "0" never; reconnect interval in seconds
+    const std::string& UA_DB_LISTEN=std::getenv("UA_DB_LISTEN")==NULL ? "auto" : std::getenv("UA_DB_LISTEN");
+    const std::string& UA_DB_LISTEN_RECONNECT=std::getenv("UA_DB_LISTEN_RECONNECT")==NULL ? "5" : std::getenv("UA_DB_LISTEN_RECONNECT");
+
+    //"1" reads unfiltered list totals from table_counters instead of count(*)
+    const std::string& UA_DB_TOTALS_FROM_COUNTERS=std::getenv("UA_DB_TOTALS_FROM_COUNTERS")==NULL ? "0" : std::getenv("UA_DB_TOTALS_FROM_COUNTERS");
+
+    //authz engine params, "1" enables in-memory decisions, refresh interval in seconds
+    const std::string& UA_AUTHZ_ENGINE=std::getenv("UA_AUTHZ_ENGINE")==NULL ? "1" : std::getenv("UA_AUTHZ_ENGINE");
+    const std::string& UA_AUTHZ_REFRESH_INTERVAL=std::getenv("UA_AUTHZ_REFRESH_INTERVAL")==NULL ? "60" : std::getenv("UA_AUTHZ_REFRESH_INTERVAL");
+    //entries per batch check request
+    const std::string& UA_AUTHZ_BATCH_MAX=std::getenv("UA_AUTHZ_BATCH_MAX")==NULL ? "100" : std::getenv("UA_AUTHZ_BATCH_MAX");
+    //decision cache entries, "0" disables, entry ttl in seconds
+    const std::string& UA_AUTHZ_CACHE_SIZE=std::getenv("UA_AUTHZ_CACHE_SIZE")==NULL ? "65536" : std::getenv("UA_AUTHZ_CACHE_SIZE");
+    const std::string& UA_AUTHZ_CACHE_TTL=std::getenv("UA_AUTHZ_CACHE_TTL")==NULL ? "60" : std::getenv("UA_AUTHZ_CACHE_TTL");
+
     params_.emplace("UA_HOST",UA_HOST);
     params_.emplace("UA_PORT",UA_PORT);
 
@@ -75,6 +140,13 @@ bool app_settings::settings_init()
     params_.emplace("UA_SIGNING_CA_CRT_PATH",UA_SIGNING_CA_CRT_PATH);
     params_.emplace("UA_SIGNING_CA_KEY_PATH",UA_SIGNING_CA_KEY_PATH);
     params_.emplace("UA_SIGNING_CA_KEY_PASS",UA_SIGNING_CA_KEY_PASS);
+    params_.emplace("UA_CA_RELOAD_INTERVAL",UA_CA_RELOAD_INTERVAL);
+    params_.emplace("UA_PKCS12_PROFILE",UA_PKCS12_PROFILE);
+    params_.emplace("UA_PKCS12_ITERATIONS",UA_PKCS12_ITERATIONS);
+    params_.emplace("UA_PKCS12_MAC_ITERATIONS",UA_PKCS12_MAC_ITERATIONS);
+    params_.emplace("UA_PKCS12_KEY_TYPE",UA_PKCS12_KEY_TYPE);
+    params_.emplace("UA_KEYPAIR_POOL_SIZE",UA_KEYPAIR_POOL_SIZE);
+    params_.emplace("UA_KEYPAIR_POOL_THREADS",UA_KEYPAIR_POOL_THREADS);
 
     params_.emplace("UA_CLIENT_CRT_PATH",UA_CLIENT_CRT_PATH);
     params_.emplace("UA_CLIENT_KEY_PATH",UA_CLIENT_KEY_PATH);
@@ -94,6 +166,32 @@ bool app_settings::settings_init()
     params_.emplace("UA_SENTRY_DSN",UA_SENTRY_DSN);
     params_.emplace("UA_SENTRY_TRACES_SAMPLE_RATE",UA_SENTRY_TRACES_SAMPLE_RATE);
 
+    params_.emplace("UA_HTTP_KEEP_ALIVE_MAX",UA_HTTP_KEEP_ALIVE_MAX);
+    params_.emplace("UA_HTTP_KEEP_ALIVE_TIMEOUT",UA_HTTP_KEEP_ALIVE_TIMEOUT);
+    params_.emplace("UA_HTTP_STREAM_LISTS",UA_HTTP_STREAM_LISTS);
+    params_.emplace("UA_HTTP_STREAMS_MAX",UA_HTTP_STREAMS_MAX);
+
+    params_.emplace("UA_IO_MODEL",UA_IO_MODEL);
+    params_.emplace("UA_IO_SHARDS",UA_IO_SHARDS);
+    params_.emplace("UA_IO_PIN_THREADS",UA_IO_PIN_THREADS);
+
+    params_.emplace("UA_DB_WORKERS",UA_DB_WORKERS);
+    params_.emplace("UA_DB_QUEUE_MAX",UA_DB_QUEUE_MAX);
+    params_.emplace("UA_CRYPTO_WORKERS",UA_CRYPTO_WORKERS);
+    params_.emplace("UA_CRYPTO_QUEUE_MAX",UA_CRYPTO_QUEUE_MAX);
+
+    params_.emplace("UA_DB_CONN_MAX_LIFETIME",UA_DB_CONN_MAX_LIFETIME);
+    params_.emplace("UA_DB_POOL_ACQUIRE_TIMEOUT",UA_DB_POOL_ACQUIRE_TIMEOUT);
+    params_.emplace("UA_DB_TOTALS_FROM_COUNTERS",UA_DB_TOTALS_FROM_COUNTERS);
+    params_.emplace("UA_DB_LISTEN",UA_DB_LISTEN);
+    params_.emplace("UA_DB_LISTEN_RECONNECT",UA_DB_LISTEN_RECONNECT);
+
+    params_.emplace("UA_AUTHZ_ENGINE",UA_AUTHZ_ENGINE);
+    params_.emplace("UA_AUTHZ_REFRESH_INTERVAL",UA_AUTHZ_REFRESH_INTERVAL);
+    params_.emplace("UA_AUTHZ_BATCH_MAX",UA_AUTHZ_BATCH_MAX);
+    params_.emplace("UA_AUTHZ_CACHE_SIZE",UA_AUTHZ_CACHE_SIZE);
+    params_.emplace("UA_AUTHZ_CACHE_TTL",UA_AUTHZ_CACHE_TTL);
+
     const std::string& tree_ {boost::json::serialize(params_)};
     std::ofstream out_fs {etc_uauth_dir_ + "/" + filename_};
     out_fs<<tree_;
@@ -114,3 +212,17 @@ std::string app_settings::value_get(const std::string &key)
     }
     return std::string {params_.at(key).as_string().c_str()};
 }
+
+int app_settings::value_get_int(const std::string &key, int default_value)
+{
+    const std::string& value {value_get(key)};
+    if(value.empty()){
+        return default_value;
+    }
+    try{
+        return std::stoi(value);
+    }
+    catch(const std::exception&){
+        return default_value;
+    }
+}
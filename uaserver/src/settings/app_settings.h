@@ -20,9 +20,13 @@ private:
 
 public:
     explicit app_settings(std::string etc_uauth_dir,std::shared_ptr<spdlog::logger> logger_ptr);
+    //UA_IO_MODEL as used, "sharded" only where SO_REUSEPORT is supported, otherwise "shared";
+    //static as main sizes its io threads before settings exist
+    static std::string io_model_get();
     bool settings_init();
     void value_set(const std::string& key,const std::string& value);
     std::string value_get(const std::string& key);
+    int value_get_int(const std::string& key,int default_value);
 };
 
 #endif // APP_SETTINGS_H
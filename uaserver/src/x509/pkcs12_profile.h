@@ -0,0 +1,21 @@
+#ifndef PKCS12_PROFILE_H
+#define PKCS12_PROFILE_H
+
+#include <string>
+
+#include <openssl/obj_mac.h>
+
+//PKCS12 encryption and MAC settings, built once from UA_PKCS12_PROFILE
+struct pkcs12_profile
+{
+    //"aes256": PBES2, AES-256-CBC with PBKDF2-HMAC-SHA256, SHA-256 MAC
+    //"legacy": 3DES with SHA-1 MAC for clients that can not read PBES2
+    std::string name {"aes256"};
+    int key_nid {NID_aes_256_cbc};
+    int cert_nid {NID_aes_256_cbc};
+    int iterations {20000};
+    int mac_nid {NID_sha256};
+    int mac_iterations {2048};
+};
+
+#endif // PKCS12_PROFILE_H
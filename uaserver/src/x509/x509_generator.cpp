@@ -1,4 +1,5 @@
 #include "x509_generator.h"
+#include "x509_keystore.h"
 #include <fstream>
 
 #include <openssl/ssl.h>
@@ -10,6 +11,7 @@
 #include <openssl/pkcs12.h>
 #include <openssl/objects.h>
 #include <openssl/x509_vfy.h>
+#include <openssl/bn.h>
 
 bool x509_generator::decrypt_subject(const std::string &path, std::unordered_multimap<std::string, std::string> &subj_map, std::string &msg)
 {
@@ -58,34 +60,50 @@ bool x509_generator::decrypt_subject(const std::string &path, std::unordered_mul
     return true;
 }
 
-bool x509_generator::create_PKCS12(const std::string &user_id, const std::string &root_path,
-                                   const std::string &pub_path, const std::string &pr_path,
-                                   const std::string &pr_pass, const std::string &pkcs_pass,
-                                   const std::string &pkcs_name, std::vector<char> &PKCS12_content, std::string &msg)
+bool x509_generator::serial_set(X509 *x509)
 {
-    try{
-        int ret {};
-        //create root X509
-        std::shared_ptr<BIO> root_bio {BIO_new_file(root_path.c_str(),"r+"),&BIO_free};
-        std::shared_ptr<X509> root_x509 {PEM_read_bio_X509(root_bio.get(),NULL,NULL,NULL),&X509_free};
+    std::shared_ptr<BIGNUM> serial {BN_new(),&BN_free};
+    if(!serial || !BN_rand(serial.get(),159,BN_RAND_TOP_ANY,BN_RAND_BOTTOM_ANY)){
+        return false;
+    }
+    return BN_to_ASN1_INTEGER(serial.get(),X509_get_serialNumber(x509))!=NULL;
+}
 
-        //create EVP_PKEY pub_key
-        std::shared_ptr<BIO> pub_bio {BIO_new_file(pub_path.c_str(),"r+"),&BIO_free};
-        std::shared_ptr<X509> pub_x509 {PEM_read_bio_X509(pub_bio.get(),NULL,NULL,NULL),&X509_free};
-        std::shared_ptr<EVP_PKEY> pub_key {X509_get_pubkey(pub_x509.get()),&EVP_PKEY_free};
-        X509_NAME* pub_name {X509_get_subject_name(pub_x509.get())};
+bool x509_generator::sign(X509 *x509, const x509_material &material, std::string &msg)
+{
+    if(!X509_set_issuer_name(x509,X509_get_subject_name(material.signing_x509.get()))){
+        msg="X509_set_issuer_name failed";
+        return false;
+    }
+    if(X509_sign(x509,material.signing_key.get(),material.signing_md)<=0){
+        msg="X509_sign failed, signing key: " + material.signing_key_type;
+        return false;
+    }
+    return true;
+}
 
-        //create EVP_PKEY pr_key
-        std::shared_ptr<BIO> pr_bio {BIO_new_file(pr_path.c_str(),"r+"),&BIO_free};
-        std::shared_ptr<EVP_PKEY> pr_key {PEM_read_bio_PrivateKey(pr_bio.get(),NULL,NULL,(unsigned char*)pr_pass.c_str()),&EVP_PKEY_free};
+bool x509_generator::create_PKCS12(const std::string &user_id, const x509_material &material, EVP_PKEY *user_key,
+                                   const pkcs12_profile &profile, const std::string &pkcs_pass, const std::string &pkcs_name,
+                                   std::string &PKCS12_content, std::string &msg)
+{
+    try{
+        int ret {};
+        X509* root_x509 {material.root_x509.get()};
+        X509* pub_x509 {material.signing_x509.get()};
+        //subject is edited below, the shared signing X509 must stay untouched
+        std::shared_ptr<X509_NAME> pub_name_copy {X509_NAME_dup(X509_get_subject_name(pub_x509)),&X509_NAME_free};
+        X509_NAME* pub_name {pub_name_copy.get()};
 
         //create X509 object
         std::shared_ptr<X509> x509 {X509_new(),&X509_free};
         ret=X509_set_version(x509.get(),2L);
+        if(!serial_set(x509.get())){
+            msg="serial number not set";
+            return false;
+        }
         X509_gmtime_adj(X509_get_notBefore(x509.get()), 0);
         X509_gmtime_adj(X509_get_notAfter(x509.get()), 31536000L * 3);
-        ret=X509_set_pubkey(x509.get(),pub_key.get());
-        ret=X509_set_issuer_name(x509.get(),pub_name);
+        ret=X509_set_pubkey(x509.get(),user_key);
 
         int last_pos {-1};
         last_pos=X509_NAME_get_index_by_NID(pub_name,NID_commonName,-1);
@@ -105,26 +123,37 @@ bool x509_generator::create_PKCS12(const std::string &user_id, const std::string
         ret=X509_set_subject_name(x509.get(),pub_name);
 
         //sign X509 object
-        ret=X509_sign(x509.get(),pr_key.get(),EVP_sha256());
+        if(!sign(x509.get(),material,msg)){
+            return false;
+        }
 
         //create and fill X509_stack
         std::shared_ptr<STACK_OF(X509)> sk_X509 {sk_X509_new_null(),&sk_X509_free};
-        ret=sk_X509_push(sk_X509.get(),pub_x509.get());
-        ret=sk_X509_push(sk_X509.get(),root_x509.get());
-
-        //create PKCS12
-        std::shared_ptr<PKCS12> pkcs {PKCS12_create(pkcs_pass.c_str(),pkcs_name.c_str(),pr_key.get(),x509.get(),sk_X509.get(),
-                                     NID_pbe_WithSHA1And3_Key_TripleDES_CBC,
-                                     NID_pbe_WithSHA1And3_Key_TripleDES_CBC,
-                                     20000,
-                                     1,
+        ret=sk_X509_push(sk_X509.get(),pub_x509);
+        ret=sk_X509_push(sk_X509.get(),root_x509);
+
+        //create PKCS12, MAC added below where its digest can be chosen
+        std::shared_ptr<PKCS12> pkcs {PKCS12_create(pkcs_pass.c_str(),pkcs_name.c_str(),user_key,x509.get(),sk_X509.get(),
+                                     profile.key_nid,
+                                     profile.cert_nid,
+                                     profile.iterations,
+                                     -1,
                                      0),&PKCS12_free};
+        if(!pkcs){
+            msg="PKCS12_create failed, profile: " + profile.name;
+            return false;
+        }
+        ret=PKCS12_set_mac(pkcs.get(),pkcs_pass.c_str(),-1,NULL,0,profile.mac_iterations,EVP_get_digestbynid(profile.mac_nid));
+        if(ret!=1){
+            msg="PKCS12_set_mac failed, profile: " + profile.name;
+            return false;
+        }
         //write PKCS12 content
         std::shared_ptr<BIO> pkcs_bio {BIO_new(BIO_s_mem()),&BIO_free};
         ret=i2d_PKCS12_bio(pkcs_bio.get(),pkcs.get());
         const int& pkcs_len {BIO_pending(pkcs_bio.get())};
         PKCS12_content.resize(pkcs_len);
-        ret=BIO_read(pkcs_bio.get(),PKCS12_content.data(),(int)PKCS12_content.size());
+        ret=BIO_read(pkcs_bio.get(),&PKCS12_content[0],(int)PKCS12_content.size());
     }
     catch(const std::exception& ex){
         msg=ex.what();
@@ -137,9 +166,8 @@ bool x509_generator::create_PKCS12(const std::string &user_id, const std::string
     return true;
 }
 
-bool x509_generator::create_X509(const std::string &pub_path, const std::string &pr_path,
-                                 const std::string &pr_pass, const std::vector<char> &x509_REQ_content,
-                                 std::vector<char> &x509_content, std::string &msg)
+bool x509_generator::create_X509(const x509_material &material, const std::string &x509_REQ_content,
+                                 std::string &x509_content, std::string &msg)
 {
     try{
         int ret {};
@@ -147,36 +175,35 @@ bool x509_generator::create_X509(const std::string &pub_path, const std::string
         std::shared_ptr<BIO> req_bio {BIO_new(BIO_s_mem()),&BIO_free};
         ret=BIO_write(req_bio.get(),x509_REQ_content.data(),(int)x509_REQ_content.size());
         std::shared_ptr<X509_REQ> req {PEM_read_bio_X509_REQ(req_bio.get(),NULL,NULL,NULL),&X509_REQ_free};
+        if(!req){
+            msg="not valid X509_REQ";
+            return false;
+        }
         EVP_PKEY* req_key {X509_REQ_get0_pubkey(req.get())};
         X509_NAME* req_name {X509_REQ_get_subject_name(req.get())};
 
-        //create EVP_PKEY pub_key
-        std::shared_ptr<BIO> pub_bio {BIO_new_file(pub_path.c_str(),"r+"),&BIO_free};
-        std::shared_ptr<X509> pub_x509 {PEM_read_bio_X509(pub_bio.get(),NULL,NULL,NULL),&X509_free};
-        std::shared_ptr<EVP_PKEY> pub_key {X509_get_pubkey(pub_x509.get()),&EVP_PKEY_free};
-        X509_NAME* pub_name {X509_get_subject_name(pub_x509.get())};
-
-        //create EVP_PKEY pr_key
-        std::shared_ptr<BIO> pr_bio {BIO_new_file(pr_path.c_str(),"r+"),&BIO_free};
-        std::shared_ptr<EVP_PKEY> pr_key {PEM_read_bio_PrivateKey(pr_bio.get(),NULL,NULL,(unsigned char*)pr_pass.c_str()),&EVP_PKEY_free};
-
         //create X509 object
         std::shared_ptr<X509> x509 {X509_new(),&X509_free};
         ret=X509_set_version(x509.get(),2L);
+        if(!serial_set(x509.get())){
+            msg="serial number not set";
+            return false;
+        }
         X509_gmtime_adj(X509_get_notBefore(x509.get()), 0);
         X509_gmtime_adj(X509_get_notAfter(x509.get()), 31536000L * 3);
         X509_set_subject_name(x509.get(),req_name);
-        X509_set_issuer_name(x509.get(),pub_name);
 
         ret=X509_set_pubkey(x509.get(),req_key);
-        ret=X509_sign(x509.get(),pr_key.get(),EVP_sha256());
+        if(!sign(x509.get(),material,msg)){
+            return false;
+        }
 
         //write X509 content
         std::shared_ptr<BIO> x509_bio {BIO_new(BIO_s_mem()),&BIO_free};
         ret=PEM_write_bio_X509(x509_bio.get(),x509.get());
         const int& x509_len {BIO_pending(x509_bio.get())};
         x509_content.resize(x509_len);
-        ret=BIO_read(x509_bio.get(),x509_content.data(),(int)x509_content.size());
+        ret=BIO_read(x509_bio.get(),&x509_content[0],(int)x509_content.size());
     }
     catch(const std::exception& ex){
         msg=ex.what();
@@ -189,6 +216,24 @@ bool x509_generator::create_X509(const std::string &pub_path, const std::string
     return true;
 }
 
+pkcs12_profile x509_generator::pkcs12_profile_make(const std::string &name, int iterations, int mac_iterations)
+{
+    pkcs12_profile profile {};
+    if(name=="legacy"){
+        profile.name=name;
+        profile.key_nid=NID_pbe_WithSHA1And3_Key_TripleDES_CBC;
+        profile.cert_nid=NID_pbe_WithSHA1And3_Key_TripleDES_CBC;
+        profile.mac_nid=NID_sha1;
+    }
+    if(iterations>0){
+        profile.iterations=iterations;
+    }
+    if(mac_iterations>0){
+        profile.mac_iterations=mac_iterations;
+    }
+    return profile;
+}
+
 x509_generator::x509_generator(std::shared_ptr<spdlog::logger> logger_ptr)
     :logger_ptr_{logger_ptr}
 {    
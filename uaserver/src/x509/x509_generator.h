@@ -7,25 +7,38 @@
 #include <unordered_map>
 #include <boost/json.hpp>
 
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#include "pkcs12_profile.h"
+
 namespace spdlog{
     class logger;
 }
+struct x509_material;
 
 class x509_generator
 {
 private:
     std::shared_ptr<spdlog::logger> logger_ptr_ {nullptr};
     bool decrypt_subject(const std::string& path,std::unordered_multimap<std::string,std::string>& subj_map,std::string& msg);
+    //random positive 159 bit serial, issuer and serial must identify one certificate
+    static bool serial_set(X509* x509);
+    //issuer from the signing CA subject, signed with the digest chosen for its key type
+    static bool sign(X509* x509,const x509_material& material,std::string& msg);
 
 public:
     explicit x509_generator(std::shared_ptr<spdlog::logger> logger_ptr);
     ~x509_generator()=default;
-    bool create_PKCS12(const std::string& user_id, const std::string& root_path, const std::string& pub_path,
-                       const std::string& pr_path, const std::string& pr_pass, const std::string& pkcs_pass,
-                       const std::string& pkcs_name, std::vector<char>& PKCS12_content, std::string& msg);
-    bool create_X509(const std::string& pub_path,const std::string& pr_path,
-                     const std::string& pr_pass,const std::vector<char>& x509_REQ_content,
-                     std::vector<char>& x509_content,std::string& msg);
+    //unknown name gives "aes256", iteration counts below 1 keep profile defaults
+    static pkcs12_profile pkcs12_profile_make(const std::string& name,int iterations,int mac_iterations);
+    //content is written in place, moved into the response body by caller,
+    //material is shared with other requests and only read, user_key is certified and packed with the chain
+    bool create_PKCS12(const std::string& user_id, const x509_material& material, EVP_PKEY* user_key,
+                       const pkcs12_profile& profile, const std::string& pkcs_pass, const std::string& pkcs_name,
+                       std::string& PKCS12_content, std::string& msg);
+    bool create_X509(const x509_material& material,const std::string& x509_REQ_content,
+                     std::string& x509_content,std::string& msg);
 };
 
 #endif // X509_GENERATOR_H
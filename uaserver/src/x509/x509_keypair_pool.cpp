@@ -0,0 +1,176 @@
+#include "x509_keypair_pool.h"
+
+#include <chrono>
+#include <boost/predef/os.h>
+#include <boost/current_function.hpp>
+#include "spdlog/spdlog.h"
+
+#include <openssl/ec.h>
+#include <openssl/rsa.h>
+#include <openssl/objects.h>
+
+#if BOOST_OS_LINUX
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+std::shared_ptr<EVP_PKEY> x509_keypair_pool::keypair_generate(std::string &msg)
+{
+    const std::chrono::steady_clock::time_point& started_at {std::chrono::steady_clock::now()};
+    std::shared_ptr<EVP_PKEY_CTX> ctx {EVP_PKEY_CTX_new_id(key_id_,NULL),&EVP_PKEY_CTX_free};
+    if(!ctx || EVP_PKEY_keygen_init(ctx.get())<=0){
+        msg="keygen init failed";
+        generate_errors_.fetch_add(1,std::memory_order_relaxed);
+        return nullptr;
+    }
+    const int& ret {key_id_==EVP_PKEY_EC ? EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx.get(),NID_X9_62_prime256v1) :
+                                           EVP_PKEY_CTX_set_rsa_keygen_bits(ctx.get(),key_bits_)};
+    EVP_PKEY* key_ptr {NULL};
+    if(ret<=0 || EVP_PKEY_keygen(ctx.get(),&key_ptr)<=0){
+        msg="keygen failed, key type: " + key_type_;
+        generate_errors_.fetch_add(1,std::memory_order_relaxed);
+        return nullptr;
+    }
+    generated_.fetch_add(1,std::memory_order_relaxed);
+    generate_us_total_.fetch_add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now()-started_at).count()),std::memory_order_relaxed);
+    return std::shared_ptr<EVP_PKEY> {key_ptr,&EVP_PKEY_free};
+}
+
+void x509_keypair_pool::fill_run()
+{
+    thread_priority_lower();
+    while(true){
+        {//wait for room in the pool
+            std::unique_lock<std::mutex> lock {mutex_};
+            cond_.wait(lock,[this](){
+                return stopped_ || keys_.size()+pending_<capacity_;
+            });
+            if(stopped_){
+                return;
+            }
+            ++pending_;
+        }
+        std::string msg {};
+        const std::shared_ptr<EVP_PKEY>& key {keypair_generate(msg)};
+        std::unique_lock<std::mutex> lock {mutex_};
+        --pending_;
+        if(key){
+            keys_.push_back(key);
+            continue;
+        }
+        if(logger_ptr_){
+            logger_ptr_->error("{}, {}",
+                BOOST_CURRENT_FUNCTION,msg);
+        }
+        //back off instead of spinning on a broken setup
+        cond_.wait_for(lock,std::chrono::seconds(1),[this](){
+            return stopped_;
+        });
+    }
+}
+
+void x509_keypair_pool::thread_priority_lower()
+{
+#if BOOST_OS_LINUX
+    //nice applies per thread on linux, request path threads keep their priority
+    const int& rc {setpriority(PRIO_PROCESS,static_cast<id_t>(syscall(SYS_gettid)),19)};
+    if(rc && logger_ptr_){
+        logger_ptr_->warn("{}, lower fill thread priority failed",
+            BOOST_CURRENT_FUNCTION);
+    }
+#endif
+}
+
+x509_keypair_pool::x509_keypair_pool(const std::string &key_type, std::size_t capacity, std::size_t threads_count,
+                                     std::shared_ptr<spdlog::logger> logger_ptr)
+    :capacity_{capacity},threads_count_{std::max<std::size_t>(1,threads_count)},logger_ptr_{logger_ptr}
+{
+    if(key_type=="rsa3072"){
+        key_bits_=3072;
+    }
+    else if(key_type=="ec256"){
+        key_id_=EVP_PKEY_EC;
+        key_bits_=256;
+    }
+    else if(key_type!="rsa2048" && logger_ptr_){
+        logger_ptr_->warn("{}, unknown key type '{}', 'rsa2048' used",
+            BOOST_CURRENT_FUNCTION,key_type);
+    }
+    key_type_=key_id_==EVP_PKEY_EC ? "ec256" : "rsa" + std::to_string(key_bits_);
+}
+
+x509_keypair_pool::~x509_keypair_pool()
+{
+    pool_stop();
+}
+
+void x509_keypair_pool::pool_start()
+{
+    //0 capacity generates every key on request
+    if(capacity_>0){
+        threads_.reserve(threads_count_);
+        for(std::size_t i=0;i<threads_count_;++i){
+            threads_.emplace_back(&x509_keypair_pool::fill_run,this);
+        }
+    }
+    if(logger_ptr_){
+        logger_ptr_->info("{}, keypair pool started, key type: {}, capacity: {}, threads: {}",
+            BOOST_CURRENT_FUNCTION,key_type_,capacity_,threads_.size());
+    }
+}
+
+void x509_keypair_pool::pool_stop()
+{
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        stopped_=true;
+    }
+    cond_.notify_all();
+    for(std::thread& thread: threads_){
+        if(thread.joinable()){
+            thread.join();
+        }
+    }
+    threads_.clear();
+}
+
+std::shared_ptr<EVP_PKEY> x509_keypair_pool::keypair_get(std::string &msg)
+{
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        if(!keys_.empty()){
+            const std::shared_ptr<EVP_PKEY> key {keys_.front()};
+            keys_.pop_front();
+            hits_.fetch_add(1,std::memory_order_relaxed);
+            cond_.notify_one();
+            return key;
+        }
+    }
+    misses_.fetch_add(1,std::memory_order_relaxed);
+    return keypair_generate(msg);
+}
+
+boost::json::object x509_keypair_pool::stats_get() const
+{
+    std::size_t size {0};
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        size=keys_.size();
+    }
+    const std::uint64_t& hits {hits_.load(std::memory_order_relaxed)};
+    const std::uint64_t& misses {misses_.load(std::memory_order_relaxed)};
+    const std::uint64_t& generated {generated_.load(std::memory_order_relaxed)};
+    return boost::json::object {
+        {"key_type",key_type_},
+        {"capacity",capacity_},
+        {"size",size},
+        {"hits",hits},
+        {"misses",misses},
+        {"hit_rate",hits+misses ? static_cast<double>(hits)/static_cast<double>(hits+misses) : 0.0},
+        {"generated",generated},
+        {"generate_errors",generate_errors_.load(std::memory_order_relaxed)},
+        {"generate_avg_us",generated ? generate_us_total_.load(std::memory_order_relaxed)/generated : 0}
+    };
+}
@@ -0,0 +1,64 @@
+#ifndef X509_KEYPAIR_POOL_H
+#define X509_KEYPAIR_POOL_H
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <string>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <condition_variable>
+#include <boost/json.hpp>
+
+#include <openssl/evp.h>
+
+namespace spdlog{
+    class logger;
+}
+
+//Per-user keys for PKCS12 issuance, generated ahead by low priority threads,
+//an empty pool falls back to generating on the calling thread
+class x509_keypair_pool
+{
+private:
+    //"rsa2048", "rsa3072" or "ec256"
+    std::string key_type_ {"rsa2048"};
+    int key_id_ {EVP_PKEY_RSA};
+    int key_bits_ {2048};
+    std::size_t capacity_ {32};
+    std::size_t threads_count_ {1};
+
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<std::shared_ptr<EVP_PKEY>> keys_ {};
+    //keys being generated by fill threads, counted against capacity
+    std::size_t pending_ {0};
+    bool stopped_ {false};
+    std::vector<std::thread> threads_ {};
+
+    std::atomic<std::uint64_t> hits_ {0};
+    std::atomic<std::uint64_t> misses_ {0};
+    std::atomic<std::uint64_t> generated_ {0};
+    std::atomic<std::uint64_t> generate_errors_ {0};
+    std::atomic<std::uint64_t> generate_us_total_ {0};
+    std::shared_ptr<spdlog::logger> logger_ptr_ {nullptr};
+
+    std::shared_ptr<EVP_PKEY> keypair_generate(std::string& msg);
+    void fill_run();
+    void thread_priority_lower();
+
+public:
+    explicit x509_keypair_pool(const std::string& key_type,std::size_t capacity,std::size_t threads_count,
+                               std::shared_ptr<spdlog::logger> logger_ptr);
+    ~x509_keypair_pool();
+
+    void pool_start();
+    void pool_stop();
+    //nullptr only when inline generation failed too
+    std::shared_ptr<EVP_PKEY> keypair_get(std::string& msg);
+    boost::json::object stats_get() const;
+};
+
+#endif // X509_KEYPAIR_POOL_H
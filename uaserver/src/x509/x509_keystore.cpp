@@ -0,0 +1,231 @@
+#include "x509_keystore.h"
+
+#include <csignal>
+#include <boost/bind/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/predef/os.h>
+#include "spdlog/spdlog.h"
+
+#include <openssl/bio.h>
+#include <openssl/pem.h>
+#include <openssl/objects.h>
+
+x509_keystore::file_stamps x509_keystore::stamps_get() const
+{
+    file_stamps stamps {};
+    for(const std::string& path:{root_path_,signing_crt_path_,signing_key_path_}){
+        boost::system::error_code ec;
+        const std::time_t& mtime {boost::filesystem::last_write_time(path,ec)};
+        const std::uintmax_t& size {boost::filesystem::file_size(path,ec)};
+        //missing file compares as zero, its appearance counts as change
+        stamps.emplace_back(ec ? 0 : mtime,ec ? 0 : size);
+    }
+    return stamps;
+}
+
+bool x509_keystore::material_load(x509_material &material, std::string &msg) const
+{
+    {//root X509
+        std::shared_ptr<BIO> bio {BIO_new_file(root_path_.c_str(),"r"),&BIO_free};
+        if(!bio){
+            msg="can not open " + root_path_;
+            return false;
+        }
+        material.root_x509.reset(PEM_read_bio_X509(bio.get(),NULL,NULL,NULL),&X509_free);
+        if(!material.root_x509){
+            msg="can not read X509 from " + root_path_;
+            return false;
+        }
+    }
+    {//signing X509
+        std::shared_ptr<BIO> bio {BIO_new_file(signing_crt_path_.c_str(),"r"),&BIO_free};
+        if(!bio){
+            msg="can not open " + signing_crt_path_;
+            return false;
+        }
+        material.signing_x509.reset(PEM_read_bio_X509(bio.get(),NULL,NULL,NULL),&X509_free);
+        if(!material.signing_x509){
+            msg="can not read X509 from " + signing_crt_path_;
+            return false;
+        }
+    }
+    {//signing key, decrypted once here instead of per request
+        std::shared_ptr<BIO> bio {BIO_new_file(signing_key_path_.c_str(),"r"),&BIO_free};
+        if(!bio){
+            msg="can not open " + signing_key_path_;
+            return false;
+        }
+        material.signing_key.reset(PEM_read_bio_PrivateKey(bio.get(),NULL,NULL,(void*)signing_key_pass_.c_str()),&EVP_PKEY_free);
+        if(!material.signing_key){
+            msg="can not read private key from " + signing_key_path_;
+            return false;
+        }
+    }
+    //files replaced one by one may briefly not belong together
+    if(X509_check_private_key(material.signing_x509.get(),material.signing_key.get())!=1){
+        msg="signing key does not match " + signing_crt_path_;
+        return false;
+    }
+    return signing_md_select(material,msg);
+}
+
+bool x509_keystore::signing_md_select(x509_material &material, std::string &msg)
+{
+    const int& bits {EVP_PKEY_bits(material.signing_key.get())};
+    switch(EVP_PKEY_base_id(material.signing_key.get())){
+    case EVP_PKEY_RSA:
+        material.signing_md=EVP_sha256();
+        material.signing_key_type="rsa" + std::to_string(bits);
+        return true;
+    case EVP_PKEY_EC:
+        //digest strength follows the curve, P-256 with SHA-256, P-384 with SHA-384, P-521 with SHA-512
+        material.signing_md=bits<=256 ? EVP_sha256() : bits<=384 ? EVP_sha384() : EVP_sha512();
+        material.signing_key_type="ec" + std::to_string(bits);
+        return true;
+#ifdef EVP_PKEY_ED25519
+    case EVP_PKEY_ED25519:
+        material.signing_md=NULL;
+        material.signing_key_type="ed25519";
+        return true;
+    case EVP_PKEY_ED448:
+        material.signing_md=NULL;
+        material.signing_key_type="ed448";
+        return true;
+#endif
+    default:
+        msg="unsupported signing key type: " + std::string {OBJ_nid2sn(EVP_PKEY_base_id(material.signing_key.get()))};
+        return false;
+    }
+}
+
+void x509_keystore::timer_wait()
+{
+    timer_.expires_from_now(boost::posix_time::seconds(reload_interval_));
+    timer_.async_wait(boost::bind(&x509_keystore::on_wait,this,boost::asio::placeholders::error));
+}
+
+void x509_keystore::on_wait(const boost::system::error_code &ec)
+{
+    if(ec==boost::asio::error::operation_aborted || stopped_){
+        return;
+    }
+    bool changed {false};
+    {
+        std::lock_guard<std::mutex> lock {reload_mutex_};
+        changed=stamps_get()!=stamps_;
+    }
+    if(changed){
+        std::string msg {};
+        keystore_reload(msg);
+    }
+    timer_wait();
+}
+
+void x509_keystore::signal_wait()
+{
+    signals_.async_wait(boost::bind(&x509_keystore::on_signal,this,
+                                    boost::asio::placeholders::error,boost::asio::placeholders::signal_number));
+}
+
+void x509_keystore::on_signal(const boost::system::error_code &ec, int signum)
+{
+    if(ec==boost::asio::error::operation_aborted || stopped_){
+        return;
+    }
+    if(logger_ptr_){
+        logger_ptr_->info("{}, signal {} received, reloading CA material",
+            BOOST_CURRENT_FUNCTION,signum);
+    }
+    std::string msg {};
+    keystore_reload(msg);
+    signal_wait();
+}
+
+x509_keystore::x509_keystore(boost::asio::io_context &io, const std::string &root_path, const std::string &signing_crt_path,
+                             const std::string &signing_key_path, const std::string &signing_key_pass, int reload_interval,
+                             std::shared_ptr<spdlog::logger> logger_ptr)
+    :root_path_{root_path},signing_crt_path_{signing_crt_path},signing_key_path_{signing_key_path},
+     signing_key_pass_{signing_key_pass},reload_interval_{std::max(0,reload_interval)},timer_{io},signals_{io},
+     logger_ptr_{logger_ptr}
+{
+}
+
+bool x509_keystore::keystore_reload(std::string &msg)
+{
+    std::lock_guard<std::mutex> lock {reload_mutex_};
+    //taken before reading, a write during the load is seen by the next check
+    stamps_=stamps_get();
+
+    const std::shared_ptr<x509_material>& material {std::make_shared<x509_material>()};
+    if(!material_load(*material,msg)){
+        reload_errors_.fetch_add(1,std::memory_order_relaxed);
+        if(logger_ptr_){
+            logger_ptr_->error("{}, CA material not loaded, previous kept: {}, error: {}",
+                BOOST_CURRENT_FUNCTION,std::atomic_load(&material_)!=nullptr,msg);
+        }
+        return false;
+    }
+    const std::shared_ptr<const x509_material>& current {std::atomic_load(&material_)};
+    material->generation=current ? current->generation+1 : 1;
+    material->loaded_at=std::time(nullptr);
+    std::atomic_store(&material_,std::shared_ptr<const x509_material> {material});
+    reloads_.fetch_add(1,std::memory_order_relaxed);
+    if(logger_ptr_){
+        logger_ptr_->info("{}, CA material loaded, generation: {}, signing key: {}",
+            BOOST_CURRENT_FUNCTION,material->generation,material->signing_key_type);
+    }
+    return true;
+}
+
+void x509_keystore::keystore_start()
+{
+#if BOOST_OS_LINUX
+    {//SIGHUP forces a reload, e.g. after the key was rotated in place
+        boost::system::error_code ec;
+        signals_.add(SIGHUP,ec);
+        if(!ec){
+            signal_wait();
+        }
+    }
+#endif
+    if(reload_interval_>0){
+        timer_wait();
+    }
+    if(logger_ptr_){
+        logger_ptr_->info("{}, x509_keystore started, reload interval: {}s",
+            BOOST_CURRENT_FUNCTION,reload_interval_);
+    }
+}
+
+void x509_keystore::keystore_stop()
+{
+    stopped_=true;
+    boost::system::error_code ec;
+    timer_.cancel(ec);
+    signals_.cancel(ec);
+    if(logger_ptr_){
+        logger_ptr_->info("{}, x509_keystore stopped",
+            BOOST_CURRENT_FUNCTION);
+    }
+}
+
+std::shared_ptr<const x509_material> x509_keystore::material_get() const
+{
+    return std::atomic_load(&material_);
+}
+
+boost::json::object x509_keystore::stats_get() const
+{
+    const std::shared_ptr<const x509_material>& material {std::atomic_load(&material_)};
+    boost::json::object stats {
+        {"loaded",material!=nullptr},
+        {"reloads",reloads_.load(std::memory_order_relaxed)},
+        {"reload_errors",reload_errors_.load(std::memory_order_relaxed)}
+    };
+    if(material){
+        stats.emplace("generation",material->generation);
+        stats.emplace("signing_key_type",material->signing_key_type);
+        stats.emplace("loaded_at",static_cast<std::int64_t>(material->loaded_at));
+    }
+    return stats;
+}
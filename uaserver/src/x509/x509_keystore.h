@@ -0,0 +1,87 @@
+#ifndef X509_KEYSTORE_H
+#define X509_KEYSTORE_H
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <memory>
+#include <vector>
+#include <ctime>
+#include <cstdint>
+#include <utility>
+#include <boost/asio.hpp>
+#include <boost/json.hpp>
+
+#include <openssl/x509.h>
+#include <openssl/evp.h>
+
+namespace spdlog{
+    class logger;
+}
+
+//Parsed CA chain and decrypted signing key, immutable once published,
+//requests keep their snapshot alive while a reload swaps in the next one
+struct x509_material
+{
+    std::shared_ptr<X509> root_x509 {nullptr};
+    std::shared_ptr<X509> signing_x509 {nullptr};
+    std::shared_ptr<EVP_PKEY> signing_key {nullptr};
+    //digest matching the signing key, NULL for EdDSA which hashes internally
+    const EVP_MD* signing_md {NULL};
+    //"rsa2048", "ec384", "ed25519", ...
+    std::string signing_key_type {};
+    std::uint64_t generation {0};
+    std::time_t loaded_at {0};
+};
+
+//Loads UA_CA_CRT_PATH, UA_SIGNING_CA_CRT_PATH and UA_SIGNING_CA_KEY_PATH once,
+//reloads on SIGHUP or when mtime or size of any file changed since the last attempt
+class x509_keystore
+{
+private:
+    typedef std::vector<std::pair<std::time_t,std::uintmax_t>> file_stamps;
+
+    const std::string root_path_;
+    const std::string signing_crt_path_;
+    const std::string signing_key_path_;
+    const std::string signing_key_pass_;
+    //seconds between file checks, 0 leaves reload to SIGHUP
+    int reload_interval_ {30};
+    boost::asio::deadline_timer timer_;
+    boost::asio::signal_set signals_;
+    std::atomic<bool> stopped_ {false};
+
+    //serializes timer and signal reloads, readers never take it
+    std::mutex reload_mutex_;
+    file_stamps stamps_ {};
+    std::shared_ptr<const x509_material> material_ {nullptr};
+
+    std::atomic<std::uint64_t> reloads_ {0};
+    std::atomic<std::uint64_t> reload_errors_ {0};
+    std::shared_ptr<spdlog::logger> logger_ptr_ {nullptr};
+
+    file_stamps stamps_get() const;
+    bool material_load(x509_material& material,std::string& msg) const;
+    //RSA, EC P-256/P-384/P-521, Ed25519 and Ed448 signing keys
+    static bool signing_md_select(x509_material& material,std::string& msg);
+    void timer_wait();
+    void on_wait(const boost::system::error_code& ec);
+    void signal_wait();
+    void on_signal(const boost::system::error_code& ec,int signum);
+
+public:
+    explicit x509_keystore(boost::asio::io_context& io,const std::string& root_path,const std::string& signing_crt_path,
+                           const std::string& signing_key_path,const std::string& signing_key_pass,int reload_interval,
+                           std::shared_ptr<spdlog::logger> logger_ptr);
+    ~x509_keystore()=default;
+
+    //Load and publish current files, on failure the previous material stays in use
+    bool keystore_reload(std::string& msg);
+    void keystore_start();
+    void keystore_stop();
+    //nullptr until a load succeeded
+    std::shared_ptr<const x509_material> material_get() const;
+    boost::json::object stats_get() const;
+};
+
+#endif // X509_KEYSTORE_H
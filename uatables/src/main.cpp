@@ -1,8 +1,10 @@
 ﻿#include <iostream>
 
 #include <iomanip>
+#include <set>
 #include <array>
 #include <string>
+#include <chrono>
 #include <thread>
 #include <vector>
 #include <utility>
@@ -230,6 +232,16 @@ bool tables_init(PGconn* conn_ptr,std::string& msg)
             return false;
         }
     }
+    {//create index for keyset pagination of users list
+        const std::string& command {"CREATE INDEX IF NOT EXISTS users_created_at_id_idx ON users (created_at, id)"};
+        res_ptr=PQexec(conn_ptr,command.c_str());
+        if(PQresultStatus(res_ptr) != PGRES_COMMAND_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            return false;
+        }
+        PQclear(res_ptr);
+    }
     {//create table 'roles_permissions'
         const std::string& command {"CREATE TABLE IF NOT EXISTS roles_permissions "
                                     "(id uuid PRIMARY KEY NOT NULL, name varchar(50) UNIQUE NOT NULL, "
@@ -277,6 +289,279 @@ bool tables_init(PGconn* conn_ptr,std::string& msg)
     return true;
 }
 
+//Drop counter triggers, writes stop taking the hot table_counters row
+bool counters_drop(PGconn* conn_ptr,std::string& msg)
+{
+    PGresult* res_ptr {NULL};
+    const std::array<std::string,3>& tables {{"users","roles_permissions","users_roles_permissions"}};
+    for(const std::string& table: tables){
+        const std::string& command {(boost::format("DROP TRIGGER IF EXISTS %1%_count ON %1%; "
+                                                   "DROP TRIGGER IF EXISTS %1%_count_truncate ON %1%")
+                                     % table).str()};
+        res_ptr=PQexec(conn_ptr,command.c_str());
+        if(PQresultStatus(res_ptr) != PGRES_COMMAND_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            return false;
+        }
+        PQclear(res_ptr);
+    }
+    {//counts are stale without triggers, a later opt-in seeds them again
+        res_ptr=PQexec(conn_ptr,"DROP TABLE IF EXISTS table_counters; DROP FUNCTION IF EXISTS table_counters_update()");
+        if(PQresultStatus(res_ptr) != PGRES_COMMAND_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            return false;
+        }
+        PQclear(res_ptr);
+    }
+    return true;
+}
+
+bool counters_init(PGconn* conn_ptr,std::string& msg)
+{
+    PGresult* res_ptr {NULL};
+    {//create table 'table_counters'
+        const std::string& command {"CREATE TABLE IF NOT EXISTS table_counters "
+                                    "(table_name varchar(63) PRIMARY KEY NOT NULL, row_count bigint NOT NULL)"};
+        res_ptr=PQexec(conn_ptr,command.c_str());
+        if(PQresultStatus(res_ptr) != PGRES_COMMAND_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            return false;
+        }
+        PQclear(res_ptr);
+    }
+    {//create trigger function 'table_counters_update'
+        const std::string& command {"CREATE OR REPLACE FUNCTION table_counters_update() RETURNS trigger "
+                                    "LANGUAGE plpgsql AS $$ BEGIN "
+                                    "IF TG_OP='INSERT' THEN "
+                                    "UPDATE table_counters SET row_count=row_count+1 WHERE table_name=TG_TABLE_NAME; "
+                                    "ELSIF TG_OP='DELETE' THEN "
+                                    "UPDATE table_counters SET row_count=row_count-1 WHERE table_name=TG_TABLE_NAME; "
+                                    "ELSE "
+                                    "UPDATE table_counters SET row_count=0 WHERE table_name=TG_TABLE_NAME; "
+                                    "END IF; "
+                                    "RETURN NULL; "
+                                    "END $$"};
+        res_ptr=PQexec(conn_ptr,command.c_str());
+        if(PQresultStatus(res_ptr) != PGRES_COMMAND_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            return false;
+        }
+        PQclear(res_ptr);
+    }
+    const std::array<std::string,3>& tables {{"users","roles_permissions","users_roles_permissions"}};
+    for(const std::string& table: tables){
+        //trigger creation locks out writers until commit, so the seed count is exact
+        const std::string& command {(boost::format("BEGIN; "
+                                                   "DROP TRIGGER IF EXISTS %1%_count ON %1%; "
+                                                   "DROP TRIGGER IF EXISTS %1%_count_truncate ON %1%; "
+                                                   "CREATE TRIGGER %1%_count AFTER INSERT OR DELETE ON %1% "
+                                                   "FOR EACH ROW EXECUTE PROCEDURE table_counters_update(); "
+                                                   "CREATE TRIGGER %1%_count_truncate AFTER TRUNCATE ON %1% "
+                                                   "FOR EACH STATEMENT EXECUTE PROCEDURE table_counters_update(); "
+                                                   "INSERT INTO table_counters SELECT '%1%', count(*) FROM %1% "
+                                                   "ON CONFLICT (table_name) DO UPDATE SET row_count=excluded.row_count; "
+                                                   "COMMIT")
+                                     % table).str()};
+        res_ptr=PQexec(conn_ptr,command.c_str());
+        if(PQresultStatus(res_ptr) != PGRES_COMMAND_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            PQclear(PQexec(conn_ptr,"ROLLBACK"));
+            return false;
+        }
+        PQclear(res_ptr);
+    }
+    return true;
+}
+
+bool notify_init(PGconn* conn_ptr,std::string& msg)
+{
+    PGresult* res_ptr {NULL};
+    {//create trigger function 'uauth_change_notify', payload "table:op:id" on channel 'uauth_changes'
+        const std::string& command {"CREATE OR REPLACE FUNCTION uauth_change_notify() RETURNS trigger "
+                                    "LANGUAGE plpgsql AS $$ DECLARE rec record; row_id text := ''; BEGIN "
+                                    "IF TG_OP='DELETE' THEN rec:=OLD; ELSIF TG_OP<>'TRUNCATE' THEN rec:=NEW; END IF; "
+                                    "IF TG_OP<>'TRUNCATE' THEN "
+                                    "IF TG_TABLE_NAME='users_roles_permissions' THEN row_id:=rec.user_id::text; "
+                                    "ELSIF TG_TABLE_NAME='roles_permissions_relationship' THEN row_id:=rec.parent_id::text; "
+                                    "ELSE row_id:=rec.id::text; "
+                                    "END IF; "
+                                    "END IF; "
+                                    "PERFORM pg_notify('uauth_changes',TG_TABLE_NAME || ':' || left(TG_OP,1) || ':' || row_id); "
+                                    "RETURN NULL; "
+                                    "END $$"};
+        res_ptr=PQexec(conn_ptr,command.c_str());
+        if(PQresultStatus(res_ptr) != PGRES_COMMAND_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            return false;
+        }
+        PQclear(res_ptr);
+    }
+    const std::array<std::string,4>& tables {{"users","roles_permissions","roles_permissions_relationship","users_roles_permissions"}};
+    for(const std::string& table: tables){
+        const std::string& command {(boost::format("BEGIN; "
+                                                   "DROP TRIGGER IF EXISTS %1%_notify ON %1%; "
+                                                   "DROP TRIGGER IF EXISTS %1%_notify_truncate ON %1%; "
+                                                   "CREATE TRIGGER %1%_notify AFTER INSERT OR UPDATE OR DELETE ON %1% "
+                                                   "FOR EACH ROW EXECUTE PROCEDURE uauth_change_notify(); "
+                                                   "CREATE TRIGGER %1%_notify_truncate AFTER TRUNCATE ON %1% "
+                                                   "FOR EACH STATEMENT EXECUTE PROCEDURE uauth_change_notify(); "
+                                                   "COMMIT")
+                                     % table).str()};
+        res_ptr=PQexec(conn_ptr,command.c_str());
+        if(PQresultStatus(res_ptr) != PGRES_COMMAND_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            PQclear(PQexec(conn_ptr,"ROLLBACK"));
+            return false;
+        }
+        PQclear(res_ptr);
+    }
+    return true;
+}
+
+//Versioned step applied once and recorded in schema_version
+struct migration
+{
+    int version;
+    const char* description;
+    //index built by command, an invalid leftover of an interrupted concurrent build is dropped first
+    const char* index;
+    const char* command;
+};
+
+//Append only, applied in order; CONCURRENTLY keeps writers running, IF NOT EXISTS makes reruns harmless.
+//users.email needs no extra index, its UNIQUE constraint already has one
+const std::array<migration,4> migrations {{
+    {1,"users_roles_permissions by role_permission_id in grant order","urp_rp_created_at_idx",
+     "CREATE INDEX CONCURRENTLY IF NOT EXISTS urp_rp_created_at_idx ON users_roles_permissions (role_permission_id, created_at)"},
+    {2,"users_roles_permissions by user_id in grant order","urp_user_created_at_idx",
+     "CREATE INDEX CONCURRENTLY IF NOT EXISTS urp_user_created_at_idx ON users_roles_permissions (user_id, created_at)"},
+    {3,"roles_permissions_relationship by child_id","rpr_child_id_idx",
+     "CREATE INDEX CONCURRENTLY IF NOT EXISTS rpr_child_id_idx ON roles_permissions_relationship (child_id)"},
+    {4,"users by lower(email)","users_lower_email_idx",
+     "CREATE INDEX CONCURRENTLY IF NOT EXISTS users_lower_email_idx ON users (lower(email))"}
+}};
+
+//Session advisory lock, instances starting together run uatables one after another,
+//released with the session on PQfinish. Polled with pg_try_advisory_lock: a waiter blocked
+//in pg_advisory_lock keeps a snapshot open, and CREATE INDEX CONCURRENTLY of the holder
+//waits for that snapshot, a deadlock postgres resolves by aborting one side
+bool schema_lock(PGconn* conn_ptr,std::string& msg)
+{
+    bool waiting {false};
+    while(true){
+        //"uautable" as bigint
+        PGresult* res_ptr {PQexec(conn_ptr,"SELECT pg_try_advisory_lock(8458170717888998501)")};
+        if(PQresultStatus(res_ptr) != PGRES_TUPLES_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            return false;
+        }
+        const bool& locked {PQgetvalue(res_ptr,0,0)[0]=='t'};
+        PQclear(res_ptr);
+        if(locked){
+            return true;
+        }
+        if(!waiting){
+            std::cout<<"Waiting for another uatables run to finish"<<std::endl;
+            waiting=true;
+        }
+        //no statement open while sleeping
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
+
+bool migrations_run(PGconn* conn_ptr,std::string& msg)
+{
+    PGresult* res_ptr {NULL};
+    {//create table 'schema_version'
+        const std::string& command {"CREATE TABLE IF NOT EXISTS schema_version "
+                                    "(version integer PRIMARY KEY NOT NULL, description varchar NOT NULL, "
+                                    "applied_at timestamptz NOT NULL DEFAULT now())"};
+        res_ptr=PQexec(conn_ptr,command.c_str());
+        if(PQresultStatus(res_ptr) != PGRES_COMMAND_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            return false;
+        }
+        PQclear(res_ptr);
+    }
+    std::set<int> applied {};
+    {//read applied versions
+        res_ptr=PQexec(conn_ptr,"SELECT version FROM schema_version");
+        if(PQresultStatus(res_ptr) != PGRES_TUPLES_OK){
+            msg=std::string {PQresultErrorMessage(res_ptr)};
+            PQclear(res_ptr);
+            return false;
+        }
+        const int& rows {PQntuples(res_ptr)};
+        for(int r=0;r<rows;++r){
+            applied.insert(std::atoi(PQgetvalue(res_ptr,r,0)));
+        }
+        PQclear(res_ptr);
+    }
+
+    for(const migration& m: migrations){
+        if(applied.count(m.version)){
+            continue;
+        }
+        {//drop invalid index left by an interrupted concurrent build, IF NOT EXISTS would keep it
+            const char* param_values[] {m.index};
+            res_ptr=PQexecParams(conn_ptr,"SELECT 1 FROM pg_index i JOIN pg_class c ON c.oid=i.indexrelid "
+                                          "WHERE c.relname=$1 AND NOT i.indisvalid",
+                                 1,NULL,param_values,NULL,NULL,0);
+            if(PQresultStatus(res_ptr) != PGRES_TUPLES_OK){
+                msg=std::string {PQresultErrorMessage(res_ptr)};
+                PQclear(res_ptr);
+                return false;
+            }
+            const bool& is_invalid {PQntuples(res_ptr)>0};
+            PQclear(res_ptr);
+            if(is_invalid){
+                const std::string& command {std::string {"DROP INDEX CONCURRENTLY IF EXISTS "} + m.index};
+                res_ptr=PQexec(conn_ptr,command.c_str());
+                if(PQresultStatus(res_ptr) != PGRES_COMMAND_OK){
+                    msg=std::string {PQresultErrorMessage(res_ptr)};
+                    PQclear(res_ptr);
+                    return false;
+                }
+                PQclear(res_ptr);
+            }
+        }
+        {//apply, outside transaction as CONCURRENTLY requires
+            res_ptr=PQexec(conn_ptr,m.command);
+            if(PQresultStatus(res_ptr) != PGRES_COMMAND_OK){
+                msg=(boost::format("migration %d failed: %s")
+                     % m.version
+                     % PQresultErrorMessage(res_ptr)).str();
+                PQclear(res_ptr);
+                return false;
+            }
+            PQclear(res_ptr);
+        }
+        {//record version
+            const std::string& version {std::to_string(m.version)};
+            const char* param_values[] {version.c_str(),m.description};
+            res_ptr=PQexecParams(conn_ptr,"INSERT INTO schema_version (version,description) VALUES($1,$2) ON CONFLICT DO NOTHING",
+                                 2,NULL,param_values,NULL,NULL,0);
+            if(PQresultStatus(res_ptr) != PGRES_COMMAND_OK){
+                msg=std::string {PQresultErrorMessage(res_ptr)};
+                PQclear(res_ptr);
+                return false;
+            }
+            PQclear(res_ptr);
+        }
+        std::cout<<"Migration "<<m.version<<" applied: "<<m.description<<std::endl;
+    }
+    return true;
+}
+
 int main(int argc,char* argv[])
 {
     boost::json::object params {};
@@ -298,6 +583,14 @@ int main(int argc,char* argv[])
             return EXIT_FAILURE;
         }
     }
+    {//one uatables run at a time across instances
+        const bool& ok {schema_lock(conn_ptr,msg)};
+        if(!ok){
+            PQfinish(conn_ptr);
+            std::cerr<<"Schema lock failed, error: "<<msg<<std::endl;
+            return EXIT_FAILURE;
+        }
+    }
     {//init tables
         const bool& ok {tables_init(conn_ptr,msg)};
         if(!ok){
@@ -306,6 +599,32 @@ int main(int argc,char* argv[])
             return EXIT_FAILURE;
         }
     }
+    {//row counters for list totals, only with UA_DB_TOTALS_FROM_COUNTERS="1" as every write updates one hot row per table
+        const char* UA_DB_TOTALS_FROM_COUNTERS {std::getenv("UA_DB_TOTALS_FROM_COUNTERS")};
+        const bool& counters {UA_DB_TOTALS_FROM_COUNTERS!=NULL && std::string {UA_DB_TOTALS_FROM_COUNTERS}=="1"};
+        const bool& ok {counters ? counters_init(conn_ptr,msg) : counters_drop(conn_ptr,msg)};
+        if(!ok){
+            PQfinish(conn_ptr);
+            std::cerr<<"Init counters failed, error: "<<msg<<std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    {//init change notifications for cache invalidation across instances
+        const bool& ok {notify_init(conn_ptr,msg)};
+        if(!ok){
+            PQfinish(conn_ptr);
+            std::cerr<<"Init notifications failed, error: "<<msg<<std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    {//apply pending schema migrations
+        const bool& ok {migrations_run(conn_ptr,msg)};
+        if(!ok){
+            PQfinish(conn_ptr);
+            std::cerr<<"Migrations failed, error: "<<msg<<std::endl;
+            return EXIT_FAILURE;
+        }
+    }
     PQfinish(conn_ptr);
     std::cout<<"Init tables success"<<std::endl;
     return EXIT_SUCCESS;